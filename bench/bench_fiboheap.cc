@@ -0,0 +1,1686 @@
+/**
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+// global
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// lib
+#include "fiboheap/bucket_queue.hpp"
+#include "fiboheap/compact_fibo_heap.hpp"
+#include "fiboheap/external_queue.hpp"
+#include "fiboheap/fibo_heap.hpp"
+#include "fiboheap/fibo_queue.hpp"
+#include "fiboheap/indexed_dary_queue.hpp"
+#include "fiboheap/ingest_queue.hpp"
+#include "fiboheap/multi_queue.hpp"
+#include "fiboheap/pairing_queue.hpp"
+#include "fiboheap/radix_queue.hpp"
+
+//! Prevents the optimizer from discarding a benchmark result
+static volatile long long g_sink = 0;
+
+//! One measurement: a name, the number of operations and named metrics such as ns_per_op
+struct Result
+{
+    std::string name;
+    long long ops;
+    std::vector<std::pair<const char *, double>> metrics;
+};
+
+//! Every measurement of the run, written out as JSON at the end
+static std::vector<Result> g_results;
+
+void report(const std::string &name, const long long &ops, const double &ns)
+{
+    std::printf("%-48s %12lld ops %10.2f ns/op\n", name.c_str(), ops, ns / ops);
+    std::fflush(stdout);
+    g_results.push_back({name, ops, {{"ns_per_op", ns / ops}}});
+}
+
+void reportBytes(const std::string &name, const long long &entries, const double &bytes)
+{
+    std::printf("%-48s %12lld ent %10.1f bytes/entry\n", name.c_str(), entries, bytes / entries);
+    g_results.push_back({name, entries, {{"bytes_per_entry", bytes / entries}}});
+}
+
+//! \returns The nanoseconds taken by \p f
+template <typename F>
+double elapsedNs(F &&f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+template <typename F>
+void timeIt(const std::string &name, const long long &ops, F &&f)
+{
+    report(name, ops, elapsedNs(f));
+}
+
+std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for(char c: s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+//! Writes the context of the run and g_results to \p path
+void writeJson(const std::string &path, const int &n, const size_t &max_size)
+{
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if(f == nullptr)
+    {
+        throw std::runtime_error("cannot open " + path + " for writing");
+    }
+#if defined(__VERSION__)
+    std::string compiler = __VERSION__;
+#else
+    std::string compiler = "unknown";
+#endif
+#if defined(NDEBUG)
+    bool ndebug = true;
+#else
+    bool ndebug = false;
+#endif
+    std::fprintf(f, "{\n  \"context\": {\"compiler\": %s, \"ndebug\": %s, \"hardware_concurrency\": %u, \"n\": %d, \"max_size\": %zu},\n",
+                 jsonString(compiler).c_str(), ndebug ? "true" : "false", std::thread::hardware_concurrency(), n, max_size);
+    std::fprintf(f, "  \"benchmarks\": [");
+    for(size_t i = 0; i < g_results.size(); i++)
+    {
+        const Result &r = g_results[i];
+        std::fprintf(f, "%s\n    {\"name\": %s, \"ops\": %lld", i == 0 ? "" : ",", jsonString(r.name).c_str(), r.ops);
+        for(auto &m: r.metrics)
+        {
+            std::fprintf(f, ", \"%s\": %.3f", m.first, m.second);
+        }
+        std::fprintf(f, "}");
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    std::fclose(f);
+}
+
+std::vector<int> randomInts(const int &n, const unsigned &seed)
+{
+    std::mt19937 gen(seed);
+    std::vector<int> v(n);
+    for(int &x: v)
+    {
+        x = (int)(gen() >> 1);
+    }
+    return v;
+}
+
+//! Fill then drain: every pop runs a consolidation over a large root list
+void benchPopDrain(const int &n)
+{
+    std::vector<int> values = randomInts(n, 1);
+    fiboheap::FiboHeap<int, int> fh;
+    for(int i = 0; i < n; i++)
+    {
+        fh.push(values[i], i);
+    }
+    timeIt("pop_drain", n, [&] {
+        long long sum = 0;
+        while(!fh.empty())
+        {
+            sum += fh.top();
+            fh.pop();
+        }
+        g_sink = sum;
+    });
+}
+
+//! Steady state: the heap stays at \p n elements while pushes and pops alternate
+void benchPushPopSteady(const int &n, const int &ops)
+{
+    std::vector<int> values = randomInts(n + ops, 2);
+    fiboheap::FiboHeap<int, int> fh;
+    for(int i = 0; i < n; i++)
+    {
+        fh.push(values[i], i);
+    }
+    timeIt("push_pop_steady", ops, [&] {
+        long long sum = 0;
+        for(int i = 0; i < ops; i++)
+        {
+            sum += fh.top();
+            fh.pop();
+            fh.push(values[n + i], i);
+        }
+        g_sink = sum;
+    });
+}
+
+//! Seeding a queue with \p n entries, one push at a time or as a single range
+void benchSeed(const int &n)
+{
+    std::vector<int> values = randomInts(n, 5);
+    std::vector<std::pair<int, int>> seed(n);
+    for(int i = 0; i < n; i++)
+    {
+        seed[i] = {values[i], i};
+    }
+    timeIt("seed_push", n, [&] {
+        fiboheap::FiboQueue<int, int> fq;
+        for(const auto &e: seed)
+        {
+            fq.push(e.first, e.second);
+        }
+        g_sink = fq.top();
+    });
+    timeIt("seed_push_range", n, [&] {
+        fiboheap::FiboQueue<int, int> fq(seed.begin(), seed.end());
+        g_sink = fq.top();
+    });
+}
+
+//! Draining in batches of \p k, with k pops or a single popN each time
+void benchPopBatch(const int &n, const size_t &k)
+{
+    std::vector<int> values = randomInts(n, 6);
+    std::vector<std::pair<int, int>> seed(n);
+    for(int i = 0; i < n; i++)
+    {
+        seed[i] = {values[i], i};
+    }
+    {
+        fiboheap::FiboQueue<int, int> fq(seed.begin(), seed.end());
+        fq.pop();
+        timeIt("pop_batch_single", n - 1, [&] {
+            long long sum = 0;
+            while(!fq.empty())
+            {
+                for(size_t i = 0; i < k && !fq.empty(); i++)
+                {
+                    sum += fq.top();
+                    fq.pop();
+                }
+            }
+            g_sink = sum;
+        });
+    }
+    {
+        fiboheap::FiboQueue<int, int> fq(seed.begin(), seed.end());
+        fq.pop();
+        std::vector<fiboheap::FiboQueue<int, int>::value_type> batch;
+        batch.reserve(k);
+        timeIt("pop_batch_popN", n - 1, [&] {
+            long long sum = 0;
+            while(!fq.empty())
+            {
+                batch.clear();
+                fq.popN(k, std::back_inserter(batch));
+                for(const auto &e: batch)
+                {
+                    sum += std::get<0>(e);
+                }
+            }
+            g_sink = sum;
+        });
+    }
+}
+
+/**
+ * Relaxation loop of a label-setting search: push the key if absent, else
+ * decrease it if the new priority is better, with a pop every 8 relaxations
+ */
+void benchRelax(const int &n_keys, const int &ops)
+{
+    std::vector<int> keys = randomInts(ops, 7);
+    std::vector<int> values = randomInts(ops, 8);
+    {
+        fiboheap::FiboQueue<int, int> fq;
+        timeIt("relax_contains_find", ops, [&] {
+            for(int i = 0; i < ops; i++)
+            {
+                int key = keys[i] % n_keys;
+                if(!fq.contains(key))
+                {
+                    fq.push(values[i], key);
+                }
+                else if(auto *x = fq.findNode(key); values[i] < x->priority)
+                {
+                    fq.decreasePriority(x, values[i]);
+                }
+                if(i % 8 == 7)
+                {
+                    fq.pop();
+                }
+            }
+            g_sink = fq.size();
+        });
+    }
+    {
+        fiboheap::FiboQueue<int, int> fq;
+        timeIt("relax_upsert", ops, [&] {
+            for(int i = 0; i < ops; i++)
+            {
+                fq.upsert(keys[i] % n_keys, values[i]);
+                if(i % 8 == 7)
+                {
+                    fq.pop();
+                }
+            }
+            g_sink = fq.size();
+        });
+    }
+}
+
+//! \p queries small searches of \p m keys on a fresh queue each time, or on a queue reused through clear(), also after a search of \p n keys
+void benchClear(const int &n, const int &m, const int &queries)
+{
+    std::vector<int> values = randomInts(n, 17);
+    auto search = [&](auto &fq, int size) {
+        for(int i = 0; i < size; i++)
+        {
+            fq.upsert(values[i] % size, values[(i + 1) % n]);
+            if(i % 4 == 3)
+            {
+                fq.pop();
+            }
+        }
+        g_sink = fq.size();
+    };
+    timeIt("clear_fresh_queue", queries, [&] {
+        for(int q = 0; q < queries; q++)
+        {
+            fiboheap::FiboQueue<int, int> fq;
+            search(fq, m);
+        }
+    });
+    fiboheap::FiboQueue<int, int> fq;
+    timeIt("clear_reused_queue", queries, [&] {
+        for(int q = 0; q < queries; q++)
+        {
+            fq.clear();
+            search(fq, m);
+        }
+    });
+    // The reset cost stays that of the small searches, but their keys are now spread over a large store
+    search(fq, n);
+    timeIt("clear_reused_queue_after_large", queries, [&] {
+        for(int q = 0; q < queries; q++)
+        {
+            fq.clear();
+            search(fq, m);
+        }
+    });
+}
+
+//! The upsert workload of benchRelax with the statistics policy \p Stats, FiboStats counters are reported as metrics
+template <typename Stats>
+void benchStats(const char *name, const int &n_keys, const int &ops)
+{
+    std::vector<int> keys = randomInts(ops, 7);
+    std::vector<int> values = randomInts(ops, 8);
+    fiboheap::FiboQueue<int, int, void, std::less<int>, fiboheap::HashNodeStore, Stats> fq;
+    timeIt(name, ops, [&] {
+        for(int i = 0; i < ops; i++)
+        {
+            fq.upsert(keys[i] % n_keys, values[i]);
+            if(i % 8 == 7)
+            {
+                fq.pop();
+            }
+        }
+        g_sink = fq.size();
+    });
+    if constexpr(std::is_same_v<Stats, fiboheap::FiboStats>)
+    {
+        fiboheap::FiboStatsSnapshot s = fq.stats().snapshot();
+        auto &metrics = g_results.back().metrics;
+        metrics.push_back({"links", double(s.links)});
+        metrics.push_back({"cuts", double(s.cuts)});
+        metrics.push_back({"cascading_cuts", double(s.cascading_cuts)});
+        metrics.push_back({"max_cascade_depth", double(s.max_cascade_depth)});
+        metrics.push_back({"consolidations", double(s.consolidations)});
+        metrics.push_back({"mean_root_list", s.consolidations ? double(s.consolidated_roots) / s.consolidations : 0.0});
+        metrics.push_back({"max_root_list", double(s.max_root_list)});
+        metrics.push_back({"max_degree", double(s.max_degree)});
+        metrics.push_back({"nodes_allocated", double(s.nodes_allocated)});
+        metrics.push_back({"slabs_allocated", double(s.slabs_allocated)});
+        metrics.push_back({"store_probes", double(s.store_probes)});
+        std::printf("%-48s links %llu, cuts %llu (cascading %llu), mean root list %.1f, max degree %llu\n",
+                    "",
+                    (unsigned long long)s.links,
+                    (unsigned long long)s.cuts,
+                    (unsigned long long)s.cascading_cuts,
+                    s.consolidations ? double(s.consolidated_roots) / s.consolidations : 0.0,
+                    (unsigned long long)s.max_degree);
+    }
+}
+
+//! Re-prioritizing random keys of a queue of \p n, in place or by erasing and pushing them again
+void benchReprioritize(const int &n, const int &ops)
+{
+    std::vector<int> values = randomInts(n + ops, 14);
+    std::vector<int> keys   = randomInts(ops, 15);
+    for(int in_place = 1; in_place >= 0; in_place--)
+    {
+        fiboheap::FiboQueue<int, int> fq;
+        for(int i = 0; i < n; i++)
+        {
+            fq.push(values[i], i);
+        }
+        timeIt(in_place ? "reprioritize_update" : "reprioritize_erase_push", ops, [&] {
+            for(int i = 0; i < ops; i++)
+            {
+                int key = keys[i] % n;
+                if(in_place)
+                {
+                    fq.updatePriority(fq.find(key), values[n + i]);
+                }
+                else
+                {
+                    fq.erase(key);
+                    fq.push(values[n + i], key);
+                }
+                if(i % 8 == 7)
+                {
+                    int top = fq.topNode()->key;
+                    fq.pop();
+                    fq.push(values[i], top);
+                }
+            }
+            g_sink = fq.top();
+        });
+    }
+}
+
+//! \returns The number of bytes allocated on the heap, 0 where it cannot be measured
+size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+//! Filling a queue with \p n long string keys then popping it, with the fast store \p Store
+template <template <typename, typename> class Store>
+void benchStringKeys(const char *name, const int &n)
+{
+    std::vector<int> values = randomInts(n, 16);
+    std::vector<std::string> keys(n);
+    for(int i = 0; i < n; i++)
+    {
+        keys[i] = "/data/objects/partition-" + std::to_string(values[i] % 97) + "/object-" + std::to_string(i);
+    }
+    size_t before = heapInUse();
+    double bytes  = 0;
+    {
+        fiboheap::FiboQueue<int, std::string, void, std::less<int>, Store> fq;
+        timeIt(name, n, [&] {
+            for(int i = 0; i < n; i++)
+            {
+                fq.upsert(keys[i], values[i]);
+            }
+            while(!fq.empty())
+            {
+                if(fq.size() == size_t(n))
+                {
+                    bytes = double(heapInUse() - before);
+                }
+                fq.pop();
+            }
+        });
+    }
+    if(bytes > 0)
+    {
+        reportBytes(std::string(name) + "_memory", n, bytes);
+    }
+}
+
+//! Priorities of the micro benchmarks are drawn from [0, kPriorityRange)
+static constexpr int kPriorityRange = 1 << 20;
+
+//! The priorities of type \p P in the order of [0, kPriorityRange), built ahead so that no conversion is timed
+template <typename P>
+struct PriorityTable
+{
+    PriorityTable()
+    {
+        values.reserve(kPriorityRange);
+        for(int v = 0; v < kPriorityRange; v++)
+        {
+            if constexpr(std::is_same_v<P, std::string>)
+            {
+                char buf[16];
+                std::snprintf(buf, sizeof(buf), "%08d", v);
+                values.emplace_back(buf);
+            }
+            else
+            {
+                values.push_back(P(v) / P(std::is_floating_point_v<P> ? 1024 : 1));
+            }
+        }
+    }
+
+    const P &operator[](const int &v) const
+    {
+        return values[v];
+    }
+
+    std::vector<P> values;
+};
+
+//! Micro benchmark engine over FiboHeap, decreasing through node handles
+template <typename P>
+struct FiboHeapEngine
+{
+    explicit FiboHeapEngine(const size_t &n)
+        : nodes(n)
+    {
+        heap.reserve(n);
+    }
+
+    void push(const P &p, const int &k)
+    {
+        nodes[k] = heap.push(p, k);
+    }
+
+    void decrease(const int &k, const P &p)
+    {
+        heap.decreasePriority(nodes[k], p);
+    }
+
+    bool empty() const
+    {
+        return heap.empty();
+    }
+
+    int pop()
+    {
+        int k = heap.topNode()->key;
+        heap.pop();
+        return k;
+    }
+
+    fiboheap::FiboHeap<P, int> heap;
+    std::vector<fiboheap::FiboNode<P, int, void> *> nodes;
+};
+
+//! Micro benchmark engine over a keyed queue, decreasing through its fast store
+template <typename Queue, typename P>
+struct KeyedEngine
+{
+    explicit KeyedEngine(const size_t &n)
+    {
+        queue.reserve(n);
+    }
+
+    void push(const P &p, const int &k)
+    {
+        queue.push(p, k);
+    }
+
+    void decrease(const int &k, const P &p)
+    {
+        queue.tryDecrease(k, p);
+    }
+
+    bool empty() const
+    {
+        return queue.empty();
+    }
+
+    int pop()
+    {
+        int k = queue.topNode()->key;
+        queue.pop();
+        return k;
+    }
+
+    Queue queue;
+};
+
+/**
+ * Micro benchmark engine over std::priority_queue with lazy deletion: a
+ * decrease pushes a second entry, and entries whose priority is not the
+ * current one of their key are skipped when they reach the top
+ */
+template <typename P>
+struct StdPqEngine
+{
+    explicit StdPqEngine(const size_t &n)
+        : current(n)
+        , live(0)
+    {}
+
+    void push(const P &p, const int &k)
+    {
+        current[k] = p;
+        pq.emplace(p, k);
+        ++live;
+    }
+
+    void decrease(const int &k, const P &p)
+    {
+        current[k] = p;
+        pq.emplace(p, k);
+    }
+
+    bool empty() const
+    {
+        return live == 0;
+    }
+
+    int pop()
+    {
+        while(pq.top().first != current[pq.top().second])
+        {
+            pq.pop();
+        }
+        int k = pq.top().second;
+        pq.pop();
+        --live;
+        return k;
+    }
+
+    std::priority_queue<std::pair<P, int>, std::vector<std::pair<P, int>>, std::greater<std::pair<P, int>>> pq;
+    std::vector<P> current;
+    size_t live;
+};
+
+/**
+ * Push, decrease, pop and mixed micro benchmarks of \p Engine on \p n elements
+ *
+ * The push, decrease and pop phases fill an empty engine with n elements,
+ * decrease n random elements and drain it, repeated until about \p min_ops
+ * operations were timed. The mixed phase keeps n elements and, per
+ * operation, pops the top, pushes it back with a new priority and decreases
+ * a random element.
+ */
+template <typename Engine, typename P>
+void benchMicro(const std::string &name, const PriorityTable<P> &table, const size_t &n, const size_t &min_ops)
+{
+    std::mt19937 gen(17);
+    size_t reps = std::max<size_t>(1, min_ops / n);
+    std::vector<int> initial(n);
+    std::vector<int> cur(n);
+    std::vector<std::pair<int, int>> decreases;
+    double push_ns = 0, decrease_ns = 0, pop_ns = 0;
+    long long decreased = 0;
+    for(size_t r = 0; r < reps; r++)
+    {
+        for(size_t k = 0; k < n; k++)
+        {
+            initial[k] = cur[k] = kPriorityRange / 2 + (int)(gen() % (kPriorityRange / 2));
+        }
+        decreases.clear();
+        for(size_t i = 0; i < n; i++)
+        {
+            int k = (int)(gen() % n);
+            if(cur[k] > 1024)
+            {
+                cur[k] -= 1 + (int)(gen() % 1024);
+                decreases.emplace_back(k, cur[k]);
+            }
+        }
+        decreased += (long long)decreases.size();
+        Engine e(n);
+        push_ns += elapsedNs([&] {
+            for(size_t k = 0; k < n; k++)
+            {
+                e.push(table[initial[k]], (int)k);
+            }
+        });
+        decrease_ns += elapsedNs([&] {
+            for(auto &d: decreases)
+            {
+                e.decrease(d.first, table[d.second]);
+            }
+        });
+        pop_ns += elapsedNs([&] {
+            long long sum = 0;
+            while(!e.empty())
+            {
+                sum += e.pop();
+            }
+            g_sink = sum;
+        });
+    }
+    std::string suffix = "/" + std::to_string(n);
+    report("micro/push/" + name + suffix, (long long)(reps * n), push_ns);
+    report("micro/decrease/" + name + suffix, decreased, decrease_ns);
+    report("micro/pop/" + name + suffix, (long long)(reps * n), pop_ns);
+
+    Engine e(n);
+    for(size_t k = 0; k < n; k++)
+    {
+        cur[k] = kPriorityRange / 2 + (int)(gen() % (kPriorityRange / 2));
+        e.push(table[cur[k]], (int)k);
+    }
+    size_t ops = reps * n;
+    // xorshift64, cheap enough to be drawn inside the timed loop
+    unsigned long long state = 88172645463325252ULL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    timeIt("micro/mixed/" + name + suffix, (long long)ops, [&] {
+        long long sum = 0;
+        for(size_t i = 0; i < ops; i++)
+        {
+            int k = e.pop();
+            sum += k;
+            cur[k] = kPriorityRange / 2 + (int)(next() % (kPriorityRange / 2));
+            e.push(table[cur[k]], k);
+            int j = (int)(next() % n);
+            if(cur[j] > 1024)
+            {
+                cur[j] -= 1 + (int)(next() % 1024);
+                e.decrease(j, table[cur[j]]);
+            }
+        }
+        g_sink = sum;
+    });
+}
+
+//! Micro benchmarks of every engine with priorities of type \p P, for sizes from 1e3 to \p max_size
+template <typename P>
+void benchMicroSuite(const std::string &type, const size_t &max_size)
+{
+    PriorityTable<P> table;
+    const size_t min_ops = 1000000;
+    for(size_t n = 1000; n <= max_size; n *= 10)
+    {
+        benchMicro<FiboHeapEngine<P>>("fibo_heap/" + type, table, n, min_ops);
+        benchMicro<KeyedEngine<fiboheap::DenseFiboQueue<P, int>, P>>("fibo_queue/" + type, table, n, min_ops);
+        benchMicro<KeyedEngine<fiboheap::DensePairingQueue<P, int>, P>>("pairing_queue/" + type, table, n, min_ops);
+        benchMicro<KeyedEngine<fiboheap::DenseDaryQueue<P, int>, P>>("4ary_queue/" + type, table, n, min_ops);
+        benchMicro<StdPqEngine<P>>("std_priority_queue/" + type, table, n, min_ops);
+    }
+}
+
+/**
+ * Directed graph in compressed sparse row form, with optional vertex
+ * coordinates for the A* heuristic
+ */
+struct Graph
+{
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<int> weights;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    //! Largest factor such that hscale * euclidean distance never exceeds the weight of an edge
+    double hscale = 0;
+
+    int size() const
+    {
+        return (int)offsets.size() - 1;
+    }
+
+    //! \returns A lower bound on the distance from \p v to \p t, 0 without coordinates
+    int heuristic(const int &v, const int &t) const
+    {
+        return xs.empty() ? 0 : (int)(hscale * std::hypot(xs[v] - xs[t], ys[v] - ys[t]));
+    }
+
+    //! \brief Computes hscale from the coordinates and the edge weights
+    void computeHeuristicScale()
+    {
+        hscale = std::numeric_limits<double>::max();
+        for(int v = 0; v < size(); v++)
+        {
+            for(int e = offsets[v]; e < offsets[v + 1]; e++)
+            {
+                double d = std::hypot(xs[v] - xs[targets[e]], ys[v] - ys[targets[e]]);
+                if(d > 0)
+                {
+                    hscale = std::min(hscale, weights[e] / d);
+                }
+            }
+        }
+        if(hscale == std::numeric_limits<double>::max())
+        {
+            hscale = 0;
+        }
+    }
+};
+
+/**
+ * Random sparse graph with \p n vertices placed in a 10000 x 10000 square and
+ * \p degree out-edges per vertex to random targets, weighted by their length
+ */
+Graph randomGraph(const int &n, const int &degree, const unsigned &seed)
+{
+    std::mt19937 gen(seed);
+    Graph g;
+    g.offsets.resize(n + 1);
+    for(int v = 0; v < n; v++)
+    {
+        g.xs.push_back(gen() % 10000);
+        g.ys.push_back(gen() % 10000);
+    }
+    for(int v = 0; v < n; v++)
+    {
+        g.offsets[v] = v * degree;
+        for(int j = 0; j < degree; j++)
+        {
+            int t = (int)(gen() % n);
+            g.targets.push_back(t);
+            g.weights.push_back(1 + (int)(std::hypot(g.xs[v] - g.xs[t], g.ys[v] - g.ys[t]) / 10) + (int)(gen() % 100));
+        }
+    }
+    g.offsets[n] = n * degree;
+    g.computeHeuristicScale();
+    return g;
+}
+
+/**
+ * Road-network-style graph: a \p width x \p height grid with edges in both
+ * directions between neighbours, whose weights model segment lengths
+ */
+Graph gridGraph(const int &width, const int &height, const unsigned &seed)
+{
+    std::mt19937 gen(seed);
+    Graph g;
+    g.offsets.push_back(0);
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            const int dx[] = {1, -1, 0, 0};
+            const int dy[] = {0, 0, 1, -1};
+            for(int j = 0; j < 4; j++)
+            {
+                int nx = x + dx[j], ny = y + dy[j];
+                if(nx >= 0 && nx < width && ny >= 0 && ny < height)
+                {
+                    g.targets.push_back(ny * width + nx);
+                    g.weights.push_back(100 + (int)(gen() % 900));
+                }
+            }
+            g.offsets.push_back((int)g.targets.size());
+            g.xs.push_back(x);
+            g.ys.push_back(y);
+        }
+    }
+    g.computeHeuristicScale();
+    return g;
+}
+
+/**
+ * Reads a graph in the format of the 9th DIMACS implementation challenge
+ *
+ * \param path The .gr file, with "p sp n m" and "a u v w" lines (1-based vertices)
+ * \param coords_path The .co file with "v id x y" lines, empty for none
+ */
+Graph readDimacs(const std::string &path, const std::string &coords_path)
+{
+    std::ifstream in(path);
+    if(!in)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+    int n = -1;
+    std::vector<std::pair<int, std::pair<int, int>>> arcs;
+    std::string line;
+    while(std::getline(in, line))
+    {
+        std::istringstream ls(line);
+        char kind = 0;
+        ls >> kind;
+        if(kind == 'p')
+        {
+            std::string format;
+            long long m = 0;
+            ls >> format >> n >> m;
+            arcs.reserve((size_t)m);
+        }
+        else if(kind == 'a')
+        {
+            int u, v, w;
+            if(!(ls >> u >> v >> w) || n < 0 || u < 1 || u > n || v < 1 || v > n || w < 0)
+            {
+                throw std::runtime_error("malformed arc in " + path + ": " + line);
+            }
+            arcs.push_back({u - 1, {v - 1, w}});
+        }
+    }
+    if(n < 0)
+    {
+        throw std::runtime_error("no problem line in " + path);
+    }
+    Graph g;
+    g.offsets.assign(n + 1, 0);
+    for(auto &a: arcs)
+    {
+        ++g.offsets[a.first + 1];
+    }
+    for(int v = 0; v < n; v++)
+    {
+        g.offsets[v + 1] += g.offsets[v];
+    }
+    g.targets.resize(arcs.size());
+    g.weights.resize(arcs.size());
+    std::vector<int> fill(g.offsets.begin(), g.offsets.end() - 1);
+    for(auto &a: arcs)
+    {
+        int e        = fill[a.first]++;
+        g.targets[e] = a.second.first;
+        g.weights[e] = a.second.second;
+    }
+    if(!coords_path.empty())
+    {
+        std::ifstream co(coords_path);
+        if(!co)
+        {
+            throw std::runtime_error("cannot open " + coords_path);
+        }
+        g.xs.assign(n, 0);
+        g.ys.assign(n, 0);
+        while(std::getline(co, line))
+        {
+            std::istringstream ls(line);
+            char kind = 0;
+            int v;
+            double x, y;
+            if(ls >> kind && kind == 'v' && ls >> v >> x >> y && v >= 1 && v <= n)
+            {
+                g.xs[v - 1] = x;
+                g.ys[v - 1] = y;
+            }
+        }
+        g.computeHeuristicScale();
+    }
+    return g;
+}
+
+//! Single source shortest paths with upsert as the relaxation step
+template <typename Queue>
+long long dijkstra(const Graph &g, const int &source)
+{
+    std::vector<int> dist(g.size(), -1);
+    Queue q;
+    q.upsert(source, 0);
+    long long settled = 0;
+    while(!q.empty())
+    {
+        int d = q.top();
+        int v = q.topNode()->key;
+        q.pop();
+        dist[v] = d;
+        ++settled;
+        for(int e = g.offsets[v]; e < g.offsets[v + 1]; e++)
+        {
+            if(dist[g.targets[e]] < 0)
+            {
+                q.upsert(g.targets[e], d + g.weights[e]);
+            }
+        }
+    }
+    return settled;
+}
+
+//! Dijkstra over std::priority_queue with lazy deletion: stale entries are skipped when popped
+long long dijkstraLazy(const Graph &g, const int &source)
+{
+    std::vector<int> dist(g.size(), -1);
+    std::vector<int> best(g.size(), std::numeric_limits<int>::max());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> q;
+    q.emplace(0, source);
+    best[source] = 0;
+    long long settled = 0;
+    while(!q.empty())
+    {
+        auto [d, v] = q.top();
+        q.pop();
+        if(dist[v] >= 0)
+        {
+            continue;
+        }
+        dist[v] = d;
+        ++settled;
+        for(int e = g.offsets[v]; e < g.offsets[v + 1]; e++)
+        {
+            int t = g.targets[e];
+            if(dist[t] < 0 && d + g.weights[e] < best[t])
+            {
+                best[t] = d + g.weights[e];
+                q.emplace(best[t], t);
+            }
+        }
+    }
+    return settled;
+}
+
+/**
+ * Point to point A* with upsert as the relaxation step, the queue holds
+ * distance + heuristic, which is monotone since the heuristic is consistent
+ */
+template <typename Queue>
+long long astar(const Graph &g, const int &source, const int &target)
+{
+    std::vector<int> dist(g.size(), -1);
+    std::vector<int> best(g.size(), std::numeric_limits<int>::max());
+    Queue q;
+    best[source] = 0;
+    q.upsert(source, g.heuristic(source, target));
+    long long settled = 0;
+    while(!q.empty())
+    {
+        int v = q.topNode()->key;
+        q.pop();
+        dist[v] = best[v];
+        ++settled;
+        if(v == target)
+        {
+            break;
+        }
+        for(int e = g.offsets[v]; e < g.offsets[v + 1]; e++)
+        {
+            int t = g.targets[e];
+            if(dist[t] < 0 && dist[v] + g.weights[e] < best[t])
+            {
+                best[t] = dist[v] + g.weights[e];
+                q.upsert(t, best[t] + g.heuristic(t, target));
+            }
+        }
+    }
+    return settled;
+}
+
+//! A* over std::priority_queue with lazy deletion
+long long astarLazy(const Graph &g, const int &source, const int &target)
+{
+    std::vector<int> dist(g.size(), -1);
+    std::vector<int> best(g.size(), std::numeric_limits<int>::max());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> q;
+    best[source] = 0;
+    q.emplace(g.heuristic(source, target), source);
+    long long settled = 0;
+    while(!q.empty())
+    {
+        int v = q.top().second;
+        q.pop();
+        if(dist[v] >= 0)
+        {
+            continue;
+        }
+        dist[v] = best[v];
+        ++settled;
+        if(v == target)
+        {
+            break;
+        }
+        for(int e = g.offsets[v]; e < g.offsets[v + 1]; e++)
+        {
+            int t = g.targets[e];
+            if(dist[t] < 0 && dist[v] + g.weights[e] < best[t])
+            {
+                best[t] = dist[v] + g.weights[e];
+                q.emplace(best[t] + g.heuristic(t, target), t);
+            }
+        }
+    }
+    return settled;
+}
+
+template <typename Queue>
+void benchDijkstra(const std::string &name, const Graph &g)
+{
+    timeIt(name, (long long)g.targets.size(), [&] { g_sink = dijkstra<Queue>(g, 0); });
+}
+
+//! \returns \p count (source, target) pairs of vertices of \p g, the same for every engine
+std::vector<std::pair<int, int>> queryPairs(const Graph &g, const int &count)
+{
+    std::mt19937 gen(18);
+    std::vector<std::pair<int, int>> pairs;
+    for(int i = 0; i < count; i++)
+    {
+        pairs.emplace_back((int)(gen() % g.size()), (int)(gen() % g.size()));
+    }
+    return pairs;
+}
+
+template <typename Queue>
+void benchAstar(const std::string &name, const Graph &g, const std::vector<std::pair<int, int>> &pairs)
+{
+    timeIt(name, (long long)pairs.size(), [&] {
+        long long settled = 0;
+        for(auto &p: pairs)
+        {
+            settled += astar<Queue>(g, p.first, p.second);
+        }
+        g_sink = settled;
+    });
+}
+
+/**
+ * Dijkstra from vertex 0 and A* between fixed random pairs on \p g, with the
+ * main queues and std::priority_queue with lazy deletion
+ */
+void benchGraph(const std::string &name, const Graph &g)
+{
+    benchDijkstra<fiboheap::DenseFiboQueue<int, int>>("dijkstra/" + name + "/fibo_queue", g);
+    benchDijkstra<fiboheap::DensePairingQueue<int, int>>("dijkstra/" + name + "/pairing_queue", g);
+    benchDijkstra<fiboheap::DenseDaryQueue<int, int>>("dijkstra/" + name + "/4ary_queue", g);
+    benchDijkstra<fiboheap::DenseRadixQueue<int, int>>("dijkstra/" + name + "/radix_queue", g);
+    timeIt("dijkstra/" + name + "/std_priority_queue", (long long)g.targets.size(), [&] { g_sink = dijkstraLazy(g, 0); });
+    std::vector<std::pair<int, int>> pairs = queryPairs(g, 20);
+    benchAstar<fiboheap::DenseFiboQueue<int, int>>("astar/" + name + "/fibo_queue", g, pairs);
+    benchAstar<fiboheap::DensePairingQueue<int, int>>("astar/" + name + "/pairing_queue", g, pairs);
+    benchAstar<fiboheap::DenseDaryQueue<int, int>>("astar/" + name + "/4ary_queue", g, pairs);
+    benchAstar<fiboheap::DenseRadixQueue<int, int>>("astar/" + name + "/radix_queue", g, pairs);
+    timeIt("astar/" + name + "/std_priority_queue", (long long)pairs.size(), [&] {
+        long long settled = 0;
+        for(auto &p: pairs)
+        {
+            settled += astarLazy(g, p.first, p.second);
+        }
+        g_sink = settled;
+    });
+}
+
+template <typename P, typename K>
+K topKey(fiboheap::FiboHeap<P, K> &h)
+{
+    return h.topNode()->key;
+}
+
+template <typename P, typename K>
+K topKey(fiboheap::PairingHeap<P, K> &h)
+{
+    return h.topNode()->key;
+}
+
+template <typename P, typename K, typename Payload, typename Comp, size_t Arity>
+K topKey(fiboheap::IndexedDaryQueue<P, K, Payload, Comp, Arity> &h)
+{
+    return h.topNode()->key;
+}
+
+template <typename P, typename K>
+K topKey(fiboheap::CompactFiboHeap<P, K> &h)
+{
+    return h.key(h.topIndex());
+}
+
+/**
+ * Decrease-key heavy mix: every pop is preceded by a few decreases on random
+ * live elements, so consolidate() and cascadingCut() dominate the run time
+ */
+template <typename Heap>
+void benchDecreaseMix(const char *name, const int &n)
+{
+    std::vector<int> values = randomInts(n, 3);
+    std::mt19937 gen(4);
+    Heap h;
+    using Handle = decltype(h.push(0, 0));
+    std::vector<Handle> handles(n);
+    // live keys, packed at the front, and the position of each key in that array
+    std::vector<int> alive(n), slot(n);
+    for(int i = 0; i < n; i++)
+    {
+        handles[i] = h.push(values[i], i);
+        slot[i] = alive[i] = i;
+    }
+    int n_alive = n;
+    timeIt(name, n, [&] {
+        long long sum = 0;
+        while(n_alive > 0)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                int k = alive[gen() % n_alive];
+                values[k] -= (int)(gen() % 1024);
+                h.decreasePriority(handles[k], values[k]);
+            }
+            int k = topKey(h);
+            sum += h.top();
+            h.pop();
+            alive[slot[k]] = alive[--n_alive];
+            slot[alive[slot[k]]] = slot[k];
+        }
+        g_sink = sum;
+    });
+}
+
+/**
+ * Scheduling mix with priorities in [0, 4096): every event pops the top key,
+ * reschedules it at a random priority and moves two random keys earlier
+ */
+template <typename Queue>
+void benchScheduling(const char *name, const int &n, const int &ops)
+{
+    const int range = 4096;
+    std::mt19937 gen(11);
+    Queue q;
+    for(int k = 0; k < n; k++)
+    {
+        q.upsert(k, (int)(gen() % range));
+    }
+    timeIt(name, ops, [&] {
+        long long sum = 0;
+        for(int i = 0; i < ops; i++)
+        {
+            for(int j = 0; j < 2; j++)
+            {
+                int k = (int)(gen() % n);
+                if(auto *x = q.find(k))
+                {
+                    q.tryDecrease(k, x->priority / 2);
+                }
+            }
+            int k = q.topNode()->key;
+            sum += q.top();
+            q.pop();
+            q.upsert(k, (int)(gen() % range));
+        }
+        g_sink = sum;
+    });
+}
+
+//! Runs \p f(t) on threads t = 0 .. \p threads - 1 and waits for all of them
+template <typename F>
+void runThreads(const int &threads, F &&f)
+{
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++)
+    {
+        workers.emplace_back(f, t);
+    }
+    for(auto &w: workers)
+    {
+        w.join();
+    }
+}
+
+/**
+ * Concurrent steady state: \p threads threads alternate pushes and pops on a
+ * queue prefilled with \p n elements, for \p ops operations in total. The
+ * MultiQueue is compared to a single FiboHeap behind a mutex.
+ */
+void benchConcurrent(const int &n, const int &ops, const int &threads)
+{
+    std::vector<int> values = randomInts(n + ops, 12);
+    int per_thread = ops / threads;
+    {
+        fiboheap::FiboHeap<int, int> fh;
+        std::mutex mutex;
+        for(int i = 0; i < n; i++)
+        {
+            fh.push(values[i], i);
+        }
+        std::string name = "concurrent_mutex_t" + std::to_string(threads);
+        timeIt(name, (long long)per_thread * threads, [&] {
+            runThreads(threads, [&](int t) {
+                for(int i = 0; i < per_thread; i += 2)
+                {
+                    int k = n + t * per_thread + i;
+                    std::lock_guard<std::mutex> guard(mutex);
+                    fh.push(values[k], k);
+                    fh.pop();
+                }
+            });
+        });
+    }
+    {
+        fiboheap::MultiQueue<int, int> mq(2 * threads);
+        for(int i = 0; i < n; i++)
+        {
+            mq.push(values[i], i);
+        }
+        std::string name = "concurrent_multiqueue_t" + std::to_string(threads);
+        timeIt(name, (long long)per_thread * threads, [&] {
+            runThreads(threads, [&](int t) {
+                for(int i = 0; i < per_thread; i += 2)
+                {
+                    int k = n + t * per_thread + i;
+                    mq.push(values[k], k);
+                    mq.tryPop();
+                }
+            });
+        });
+    }
+}
+
+/**
+ * Producers and one consumer: \p producers threads submit \p ops elements in
+ * total while the consumer pops them all, through a FiboQueue behind a mutex
+ * or through an IngestQueue
+ */
+void benchIngest(const int &ops, const int &producers)
+{
+    std::vector<int> values = randomInts(ops, 13);
+    int per_producer = ops / producers;
+    int total = per_producer * producers;
+    {
+        fiboheap::FiboQueue<int, int> fq;
+        std::mutex mutex;
+        std::string name = "ingest_mutex_p" + std::to_string(producers);
+        timeIt(name, total, [&] {
+            std::thread consumer([&] {
+                for(int popped = 0; popped < total;)
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    if(!fq.empty())
+                    {
+                        fq.pop();
+                        ++popped;
+                    }
+                }
+            });
+            runThreads(producers, [&](int t) {
+                for(int i = t * per_producer; i < (t + 1) * per_producer; i++)
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    fq.push(values[i], i);
+                }
+            });
+            consumer.join();
+        });
+    }
+    {
+        fiboheap::IngestQueue<fiboheap::FiboQueue<int, int>> iq(producers);
+        std::string name = "ingest_rings_p" + std::to_string(producers);
+        timeIt(name, total, [&] {
+            std::thread consumer([&] {
+                for(int popped = 0; popped < total;)
+                {
+                    if(!iq.empty())
+                    {
+                        iq.queue().pop();
+                        ++popped;
+                    }
+                }
+            });
+            runThreads(producers, [&](int t) {
+                for(int i = t * per_producer; i < (t + 1) * per_producer; i++)
+                {
+                    iq.push(t, values[i], i);
+                }
+            });
+            consumer.join();
+        });
+    }
+}
+
+/**
+ * Per operation latency: bursts of \p burst pushes, each followed by as many
+ * push/pop pairs, every operation being timed on its own. With \p budget 0
+ * the first pop after a burst consolidates the whole burst.
+ */
+void benchLatency(const char *name, const int &burst, const int &rounds, const size_t &budget)
+{
+    std::vector<int> values = randomInts(2 * burst * rounds, 14);
+    std::vector<double> latencies;
+    latencies.reserve(3 * burst * rounds);
+    fiboheap::FiboHeap<int, int> fh;
+    fh.setConsolidationBudget(budget);
+    size_t v = 0;
+    auto timed = [&](auto &&op) {
+        auto start = std::chrono::steady_clock::now();
+        op();
+        auto stop = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    };
+    for(int r = 0; r < rounds; r++)
+    {
+        for(int i = 0; i < burst; i++, v++)
+        {
+            timed([&] { fh.push(values[v], (int)v); });
+        }
+        for(int i = 0; i < burst; i++, v++)
+        {
+            timed([&] { fh.pop(); });
+            timed([&] { fh.push(values[v], (int)v); });
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double q) { return latencies[(size_t)(q * (latencies.size() - 1))]; };
+    std::printf("%-48s %12zu ops p50 %8.0f ns p99 %8.0f ns p999 %10.0f ns max %12.0f ns\n",
+                name,
+                latencies.size(),
+                pct(0.5),
+                pct(0.99),
+                pct(0.999),
+                latencies.back());
+    g_results.push_back({name,
+                         (long long)latencies.size(),
+                         {{"p50_ns", pct(0.5)}, {"p99_ns", pct(0.99)}, {"p999_ns", pct(0.999)}, {"max_ns", latencies.back()}}});
+}
+
+//! Merging \p workers frontiers of \p n / workers overlapping keys, by meld or by re-upserting every element
+void benchMeld(const int &n, const int &workers)
+{
+    using Queue = fiboheap::DenseFiboQueue<int, int>;
+    std::vector<int> values = randomInts(2 * n, 13);
+    auto frontiers = [&]() {
+        std::vector<Queue> queues(workers);
+        for(int i = 0; i < n; i++)
+        {
+            queues[i % workers].upsert(values[n + i] % n, values[i]);
+        }
+        return queues;
+    };
+    std::vector<Queue> queues = frontiers();
+    timeIt("meld_frontiers", n, [&] {
+        for(int w = 1; w < workers; w++)
+        {
+            queues[0].meld(std::move(queues[w]));
+        }
+        g_sink = queues[0].top();
+    });
+    queues = frontiers();
+    timeIt("meld_by_upsert", n, [&] {
+        for(int w = 1; w < workers; w++)
+        {
+            while(!queues[w].empty())
+            {
+                queues[0].upsert(queues[w].topNode()->key, queues[w].top());
+                queues[w].pop();
+            }
+        }
+        g_sink = queues[0].top();
+    });
+}
+
+//! Forking a queue of \p n elements \p forks times and popping from the fork, by clone() or by pushing the elements into a new queue
+void benchClone(const int &n, const int &forks)
+{
+    using Queue = fiboheap::DenseFiboQueue<int, int>;
+    std::vector<int> values = randomInts(2 * n, 18);
+    Queue fq;
+    for(int i = 0; i < n; i++)
+    {
+        fq.upsert(values[n + i] % n, values[i]);
+    }
+    fq.pop();
+    std::vector<std::pair<int, int>> elements;
+    elements.reserve(fq.size());
+    for(int k = 0; k < n; k++)
+    {
+        if(auto *x = fq.find(k); x != nullptr)
+        {
+            elements.emplace_back(x->priority, k);
+        }
+    }
+    timeIt("clone_queue", (long long)forks * fq.size(), [&] {
+        for(int f = 0; f < forks; f++)
+        {
+            Queue copy = fq.clone();
+            copy.pop();
+            g_sink = copy.top();
+        }
+    });
+    timeIt("clone_by_push_range", (long long)forks * fq.size(), [&] {
+        for(int f = 0; f < forks; f++)
+        {
+            Queue copy;
+            copy.reserve(fq.size());
+            copy.push_range(elements.begin(), elements.end());
+            copy.pop();
+            g_sink = copy.top();
+        }
+    });
+}
+
+//! Restoring a queue of \p n elements from a snapshot file and popping once, against rebuilding it by push_range
+void benchSnapshot(const int &n)
+{
+    using Queue = fiboheap::DenseFiboQueue<int, int>;
+    const std::string path = (std::filesystem::temp_directory_path() / "fiboheap_bench_snapshot.bin").string();
+    std::vector<int> values = randomInts(2 * n, 19);
+    Queue fq;
+    for(int i = 0; i < n; i++)
+    {
+        fq.upsert(values[n + i] % n, values[i]);
+    }
+    fq.pop();
+    std::vector<std::pair<int, int>> elements;
+    elements.reserve(fq.size());
+    for(int k = 0; k < n; k++)
+    {
+        if(auto *x = fq.find(k); x != nullptr)
+        {
+            elements.emplace_back(x->priority, k);
+        }
+    }
+    timeIt("snapshot_save", fq.size(), [&] { fq.save(path); });
+    timeIt("snapshot_load_heap", fq.size(), [&] {
+        fiboheap::FiboHeap<int, int> h;
+        h.load(path);
+        h.pop();
+        g_sink = h.top();
+    });
+    timeIt("snapshot_load_queue", fq.size(), [&] {
+        Queue copy;
+        copy.load(path);
+        copy.pop();
+        g_sink = copy.top();
+    });
+    timeIt("snapshot_rebuild_by_push_range", fq.size(), [&] {
+        Queue copy;
+        copy.reserve(fq.size());
+        copy.push_range(elements.begin(), elements.end());
+        copy.pop();
+        g_sink = copy.top();
+    });
+    std::filesystem::remove(path);
+}
+
+//! A search-like workload on a frontier of \p n keys: \p n upserts, then \p n pops each followed by an upsert of a later priority
+template <typename Queue>
+void benchFrontier(const char *name, const int &n, Queue &queue)
+{
+    std::vector<int> values = randomInts(4 * n, 20);
+    timeIt(name, 3LL * n, [&] {
+        for(int i = 0; i < n; i++)
+        {
+            queue.upsert(values[i] % (2 * n), values[n + i] % n);
+        }
+        for(int i = 0; i < n && !queue.empty(); i++)
+        {
+            int p = queue.top();
+            queue.pop();
+            queue.upsert(values[2 * n + i] % (2 * n), p + values[3 * n + i] % 1000);
+        }
+        g_sink = queue.empty() ? 0 : queue.top();
+    });
+}
+
+//! The frontier workload of benchFrontier in memory and with an external queue capped to a fraction of the frontier
+void benchExternal(const int &n)
+{
+    using External = fiboheap::ExternalQueue<int, int>;
+    fiboheap::FiboQueue<int, int> fq;
+    benchFrontier("frontier_in_memory", n, fq);
+    for(size_t divisor: {4, 16, 64})
+    {
+        // blocks small enough for a fan-in of 8 runs
+        size_t budget = n * External::kEntryBytes / divisor;
+        External eq(budget, std::filesystem::temp_directory_path().string(), std::min(External::kDefaultBlockBytes, budget / 64));
+        benchFrontier(("frontier_external_ram_1_" + std::to_string(divisor)).c_str(), n, eq);
+        std::printf("%-48s %12llu spilled\n", "", (unsigned long long)eq.spilled());
+    }
+}
+
+static const char *kUsage =
+    "usage: fiboheap_bench [n] [--suite micro,graph,features] [--max-size N] [--json FILE]\n"
+    "                      [--dimacs FILE.gr [--coords FILE.co]]...\n"
+    "  n            size of the feature benchmarks and of the generated graphs (default 1e6)\n"
+    "  --suite      comma separated suites to run (default all)\n"
+    "  --max-size   largest size of the micro benchmarks, from 1e3 by powers of 10 (default 1e6, up to 1e8)\n"
+    "  --json       writes every measurement to FILE as JSON\n"
+    "  --dimacs     adds a DIMACS shortest path graph to the graph suite, --coords gives its coordinates for A*\n";
+
+int main(int argc, char *argv[])
+{
+    int n            = 1000000;
+    size_t max_size  = 1000000;
+    std::string json;
+    std::string suites = "micro,graph,features";
+    std::vector<std::pair<std::string, std::string>> dimacs;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value  = i + 1 < argc;
+        if(arg == "--json" && has_value)
+        {
+            json = argv[++i];
+        }
+        else if(arg == "--suite" && has_value)
+        {
+            suites = argv[++i];
+        }
+        else if(arg == "--max-size" && has_value)
+        {
+            max_size = (size_t)std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--dimacs" && has_value)
+        {
+            dimacs.emplace_back(argv[++i], "");
+        }
+        else if(arg == "--coords" && has_value && !dimacs.empty())
+        {
+            dimacs.back().second = argv[++i];
+        }
+        else if(!arg.empty() && arg[0] != '-')
+        {
+            n = (int)std::strtod(arg.c_str(), nullptr);
+        }
+        else
+        {
+            std::fputs(kUsage, stderr);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    auto run = [&suites](const char *suite) { return ("," + suites + ",").find("," + std::string(suite) + ",") != std::string::npos; };
+
+    try
+    {
+        if(run("micro"))
+        {
+            benchMicroSuite<int>("int", max_size);
+            benchMicroSuite<double>("double", max_size);
+            benchMicroSuite<std::string>("string", max_size);
+        }
+
+        if(run("graph"))
+        {
+            Graph g = randomGraph(n, 4, 9);
+            benchGraph("random", g);
+            benchDijkstra<fiboheap::FiboQueue<int, int>>("dijkstra/random/fibo_queue_hash_store", g);
+            benchDijkstra<fiboheap::PairingQueue<int, int>>("dijkstra/random/pairing_queue_hash_store", g);
+            benchDijkstra<fiboheap::DenseDaryQueue<int, int, void, std::less<int>, 2>>("dijkstra/random/2ary_queue", g);
+
+            int side   = (int)std::sqrt((double)n);
+            Graph grid = gridGraph(side, side, 10);
+            benchGraph("grid", grid);
+
+            for(auto &file: dimacs)
+            {
+                Graph d = readDimacs(file.first, file.second);
+                benchGraph("dimacs:" + file.first.substr(file.first.find_last_of('/') + 1), d);
+            }
+        }
+
+        if(run("features"))
+        {
+            benchPopDrain(n);
+            benchPushPopSteady(n / 10, n);
+            benchDecreaseMix<fiboheap::FiboHeap<int, int>>("decrease_mix_pointer", n);
+            benchDecreaseMix<fiboheap::CompactFiboHeap<int, int>>("decrease_mix_compact", n);
+            benchDecreaseMix<fiboheap::PairingHeap<int, int>>("decrease_mix_pairing", n);
+            benchDecreaseMix<fiboheap::IndexedDaryQueue<int, int>>("decrease_mix_4ary", n);
+            benchLatency("latency_eager", n / 10, 10, 0);
+            benchLatency("latency_budget_1", n / 10, 10, 1);
+            benchLatency("latency_budget_4", n / 10, 10, 4);
+            benchSeed(n);
+            benchPopBatch(n, 256);
+            benchRelax(n, n);
+            benchReprioritize(n / 10, n);
+            benchClear(n, 1000, 1000);
+            benchStats<fiboheap::NoStats>("stats_none", n / 10, n);
+            benchStats<fiboheap::FiboStats>("stats_fibo", n / 10, n);
+            benchStringKeys<fiboheap::HashNodeStore>("string_keys_hash_store", n);
+            benchStringKeys<fiboheap::KeyOnceNodeStore>("string_keys_key_once_store", n);
+            benchMeld(n, 8);
+            benchClone(n, 4);
+            benchSnapshot(n);
+            benchExternal(n);
+
+            int max_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+            for(int threads = 1; threads <= std::min(64, max_threads); threads *= 2)
+            {
+                benchConcurrent(n / 10, n, threads);
+                benchIngest(n, threads);
+            }
+
+            benchScheduling<fiboheap::DenseFiboQueue<int, int>>("scheduling_fibo", n / 10, n);
+            benchScheduling<fiboheap::DenseDaryQueue<int, int>>("scheduling_4ary", n / 10, n);
+            benchScheduling<fiboheap::DenseBucketQueue<int, int>>("scheduling_bucket", n / 10, n);
+        }
+
+        if(!json.empty())
+        {
+            writeJson(json, n, max_size);
+        }
+    }
+    catch(const std::exception &e)
+    {
+        std::fprintf(stderr, "fiboheap_bench: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,443 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local
+#include "fiboheap/bucket_node.hpp"
+#include "fiboheap/fibo_node_pool.hpp"
+#include "fiboheap/fibo_store.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Bucket queue (Dial's algorithm) for integer priorities in a small range [0, R)
+     *
+     * Every priority has its own bucket, a doubly linked list of nodes, so push,
+     * decreasePriority and removeNode are O(1). The non-empty buckets are tracked
+     * in a two level occupancy bitmap, pop finds the next one with a couple of
+     * count trailing zeros, in O(1) for R up to 4096 and O(R / 4096) in general.
+     *
+     * \tparam PriorityType An integral type
+     * \tparam KeyType The type being stored
+     * \tparam PayloadType The type of the payload to associate with the key
+     * \tparam Store The fast store mapping keys to nodes (HashNodeStore or DenseNodeStore)
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              template <typename, typename> class Store = HashNodeStore>
+    class BucketQueue
+    {
+        static_assert(std::is_integral_v<PriorityType>, "BucketQueue requires integral priorities");
+
+        using Word = std::uint64_t;
+
+        static constexpr size_t kWordBits = std::numeric_limits<Word>::digits;
+
+       public:
+        using Node = BucketNode<PriorityType, KeyType, PayloadType>;
+        using NodeStore = Store<KeyType, Node>;
+        //! Element moved out of the queue, (priority, key[, payload])
+        using value_type = std::conditional_t<std::is_void_v<PayloadType>,
+                                              std::tuple<PriorityType, KeyType>,
+                                              std::tuple<PriorityType, KeyType, PayloadType>>;
+
+        //! Range of priorities of a default constructed queue
+        static constexpr size_t kDefaultRange = 4096;
+
+        /**!
+         * \brief Constructor
+         *
+         * \param range Priorities must be in [0, \p range)
+         */
+        explicit BucketQueue(size_t range = kDefaultRange)
+            : m_n(0)
+            , m_min(0)
+            , m_buckets(range, nullptr)
+            , m_words((range + kWordBits - 1) / kWordBits, 0)
+            , m_summary((m_words.size() + kWordBits - 1) / kWordBits, 0)
+        {}
+
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        BucketQueue(InputIt first, InputIt last, size_t range = kDefaultRange)
+            : BucketQueue(range)
+        {
+            push_range(first, last);
+        }
+
+        BucketQueue(const BucketQueue&) = delete;
+        BucketQueue& operator=(const BucketQueue&) = delete;
+
+        //! \brief Destructor
+        ~BucketQueue() noexcept
+        {
+            deleteNodes();
+        }
+
+        //! \returns If the queue has no elements
+        bool empty() const noexcept
+        {
+            return m_n == 0;
+        }
+
+        //! \returns The number of elements in the queue
+        size_t size() const noexcept
+        {
+            return m_n;
+        }
+
+        //! \returns The number of buckets, priorities must be in [0, range())
+        size_t range() const noexcept
+        {
+            return m_buckets.size();
+        }
+
+        //! \brief Pre-allocates the node pool and the fast store for \p n elements
+        void reserve(size_t n)
+        {
+            m_pool.reserve(n);
+            m_fstore.reserve(n);
+        }
+
+        //! \returns The minimum node of the queue, nullptr if the queue is empty
+        Node* minimum() const
+        {
+            return empty() ? nullptr : m_buckets[m_min];
+        }
+
+        //! \returns The node at the top of the queue
+        Node* topNode() const
+        {
+            return minimum();
+        }
+
+        //! \returns The priority at the top of the queue
+        const PriorityType& top() const
+        {
+            return m_buckets[m_min]->priority;
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            return m_fstore.find(key);
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* findNode(const KeyType& key) const
+        {
+            return find(key);
+        }
+
+        //! \returns Whether the \p key is in the queue
+        bool contains(const KeyType& key) const
+        {
+            return m_fstore.find(key) != nullptr;
+        }
+
+        //! \brief Removes the top element from the queue
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            removeNode(m_buckets[m_min]);
+        }
+
+        //! \brief Removes \p x from the queue
+        void removeNode(Node* x)
+        {
+            unlink(x);
+            if(--m_n != 0 && m_buckets[m_min] == nullptr)
+            {
+                m_min = nextBucket(m_min);
+            }
+            m_fstore.erase(x->key);
+            m_pool.destroy(x);
+        }
+
+        //! \brief Pushes \p key onto the queue
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        /**!
+         * \brief Pushes \p key onto the queue, constructing its payload in place from \p args
+         *
+         * \throws std::out_of_range if \p priority is not in [0, range())
+         */
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            size_t b = bucketOf(priority);
+            Node* x  = m_pool.create(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            m_fstore.insert(x->key, x);
+            insert(x, b);
+            return x;
+        }
+
+        /**!
+         * \brief Pushes a range of elements onto the queue in a single pass
+         *
+         * \param first, last The range of tuple-like elements (priority, key[, payload])
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                reserve(m_n + static_cast<size_t>(std::distance(first, last)));
+            }
+            for(; first != last; ++first)
+            {
+                std::apply([this](auto&&... args) { emplace(std::forward<decltype(args)>(args)...); }, *first);
+            }
+        }
+
+        /**!
+         * \brief Decrease the priority of a node in the queue, in O(1)
+         *
+         * \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+         * \throws std::out_of_range if \p new_priority is not in [0, range())
+         */
+        bool decreasePriority(Node* x, PriorityType new_priority)
+        {
+            if(x->priority < new_priority)
+            {
+                return false;
+            }
+            size_t b = bucketOf(new_priority);
+            unlink(x);
+            x->priority = new_priority;
+            link(x, b);
+            if(b < m_min)
+            {
+                m_min = b;
+            }
+            return true;
+        }
+
+        //! \see FiboQueue::upsert
+        template <typename... Payload>
+        UpdateResult upsert(KeyType key, PriorityType priority, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "upsert takes at most one payload");
+            size_t b = bucketOf(priority);
+            auto [x, inserted] = m_fstore.findOrInsert(key, [&]() {
+                return m_pool.create(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+            });
+            if(inserted)
+            {
+                insert(x, b);
+                return UpdateResult::Inserted;
+            }
+            if(!(priority < x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            if constexpr(sizeof...(Payload) == 1)
+            {
+                ((x->payload = std::forward<Payload>(payload)), ...);
+            }
+            return UpdateResult::Improved;
+        }
+
+        //! \see FiboQueue::tryDecrease
+        UpdateResult tryDecrease(const KeyType& key, PriorityType priority)
+        {
+            Node* x = m_fstore.find(key);
+            if(x == nullptr)
+            {
+                return UpdateResult::Absent;
+            }
+            if(!(priority < x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            return UpdateResult::Improved;
+        }
+
+        //! \brief Clears all the elements from the queue
+        void clear()
+        {
+            deleteNodes();
+            m_fstore.clear();
+            m_n   = 0;
+            m_min = 0;
+        }
+
+       private:
+        //! \returns The index of the lowest set bit of \p w, which must not be 0
+        static size_t lowestBit(Word w)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_t>(__builtin_ctzll(w));
+#else
+            size_t i = 0;
+            for(; !(w & 1); w >>= 1)
+            {
+                ++i;
+            }
+            return i;
+#endif
+        }
+
+        size_t bucketOf(PriorityType priority) const
+        {
+            bool negative = false;
+            if constexpr(std::is_signed_v<PriorityType>)
+            {
+                negative = priority < 0;
+            }
+            if(negative || static_cast<size_t>(priority) >= m_buckets.size())
+            {
+                throw std::out_of_range("BucketQueue priority is out of range");
+            }
+            return static_cast<size_t>(priority);
+        }
+
+        void link(Node* x, size_t b)
+        {
+            x->prev = nullptr;
+            x->next = m_buckets[b];
+            if(x->next != nullptr)
+            {
+                x->next->prev = x;
+            }
+            else
+            {
+                m_words[b / kWordBits] |= Word(1) << (b % kWordBits);
+                m_summary[b / kWordBits / kWordBits] |= Word(1) << (b / kWordBits % kWordBits);
+            }
+            m_buckets[b] = x;
+        }
+
+        void unlink(Node* x)
+        {
+            size_t b = static_cast<size_t>(x->priority);
+            if(x->prev != nullptr)
+            {
+                x->prev->next = x->next;
+            }
+            else
+            {
+                m_buckets[b] = x->next;
+            }
+            if(x->next != nullptr)
+            {
+                x->next->prev = x->prev;
+            }
+            else if(m_buckets[b] == nullptr)
+            {
+                size_t w = b / kWordBits;
+                if((m_words[w] &= ~(Word(1) << (b % kWordBits))) == 0)
+                {
+                    m_summary[w / kWordBits] &= ~(Word(1) << (w % kWordBits));
+                }
+            }
+        }
+
+        void insert(Node* x, size_t b)
+        {
+            link(x, b);
+            if(m_n++ == 0 || b < m_min)
+            {
+                m_min = b;
+            }
+        }
+
+        //! \returns The first non-empty bucket after \p b, there must be one
+        size_t nextBucket(size_t b) const
+        {
+            size_t w = b / kWordBits;
+            if(Word bits = m_words[w] & (~Word(0) << (b % kWordBits)); bits != 0)
+            {
+                return w * kWordBits + lowestBit(bits);
+            }
+            // Next non-empty word from the summary
+            size_t s     = (w + 1) / kWordBits;
+            Word summary = (w + 1) % kWordBits == 0 ? m_summary[s] : m_summary[s] & (~Word(0) << ((w + 1) % kWordBits));
+            while(summary == 0)
+            {
+                summary = m_summary[++s];
+            }
+            w = s * kWordBits + lowestBit(summary);
+            return w * kWordBits + lowestBit(m_words[w]);
+        }
+
+        void deleteNodes()
+        {
+            for(size_t b = 0; b < m_buckets.size(); ++b)
+            {
+                for(Node* x = m_buckets[b]; x != nullptr;)
+                {
+                    Node* next = x->next;
+                    m_pool.destroy(x);
+                    x = next;
+                }
+                m_buckets[b] = nullptr;
+            }
+            std::fill(m_words.begin(), m_words.end(), 0);
+            std::fill(m_summary.begin(), m_summary.end(), 0);
+        }
+
+        size_t m_n;
+        //! Bucket of the minimum, meaningful when the queue is not empty
+        size_t m_min;
+        //! Head of the list of nodes of each bucket
+        std::vector<Node*> m_buckets;
+        //! Bit b is set iff bucket b is not empty
+        std::vector<Word> m_words;
+        //! Bit w is set iff word w of m_words is not zero
+        std::vector<Word> m_summary;
+        FiboNodePool<Node> m_pool;
+        NodeStore m_fstore;
+    };
+
+    /**!
+     * \brief A BucketQueue for integer keys in [0, N), whose fast store is a flat array
+     *
+     * \see DenseNodeStore
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void>
+    using DenseBucketQueue = BucketQueue<PriorityType, KeyType, PayloadType, DenseNodeStore>;
+}  // namespace fiboheap
@@ -0,0 +1,574 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local
+#include "fiboheap/fibo_node.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Fibonacci heap with contiguous node storage and 32 bit links
+     *
+     * Same algorithms as FiboHeap, but nodes live in two parallel arrays and are
+     * addressed by index. The hot array holds what consolidate() and cut() touch
+     * (priority, links and a packed degree/mark word), the cold array holds the
+     * key and payload, which are destroyed when the element is popped. Handles
+     * are indices and stay valid until the element is popped. Limited to less than 2^32 - 1 elements.
+     *
+     * \tparam PriorityType The type used to represent the priority of the nodes
+     * \tparam KeyType The type used for the identifier of the payloads
+     * \tparam PayloadType The data to store with each node, void for none
+     * \tparam Comparator A comparison of priorities
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comparator = std::less<PriorityType>>
+    class CompactFiboHeap
+    {
+       public:
+        using Index = std::uint32_t;
+
+        //! Index used as the null link
+        static constexpr Index kNil = std::numeric_limits<Index>::max();
+
+       protected:
+        //! Bit of HotNode::degree_mark holding the mark, the remaining bits hold the degree
+        static constexpr std::uint32_t kMarkBit = std::uint32_t(1) << 31;
+
+        //! Bound on the degree of any node: D(n) <= log_phi(n) < 47 for any 32 bit size
+        static constexpr int kMaxDegree = 48;
+
+        struct HotNode
+        {
+            PriorityType priority;
+            Index p;
+            Index left;
+            Index right;
+            Index child;
+            std::uint32_t degree_mark;
+        };
+
+        struct ColdNode : public FiboPayload<PayloadType>
+        {
+            template <typename... Args>
+            explicit ColdNode(KeyType k, Args&&... args)
+                : FiboPayload<PayloadType>(std::forward<Args>(args)...)
+                , key(std::move(k))
+            {}
+
+            KeyType key;
+        };
+
+        //! Raw storage of a ColdNode, which lives from emplace() to release() while the slot is in the heap
+        struct ColdSlot
+        {
+            alignas(ColdNode) unsigned char storage[sizeof(ColdNode)];
+        };
+
+       public:
+        //! \brief Default Constructor
+        CompactFiboHeap()
+            : m_n(0)
+            , m_min(kNil)
+            , m_free(kNil)
+        {
+            m_degree_table.fill(kNil);
+        }
+
+        /**!
+         * \brief Copy Constructor
+         *
+         * The hot array is copied as a whole and, links being indices, needs no
+         * rebasing. The cold array too when its nodes are trivially copyable,
+         * otherwise the key and payload of every slot in the heap are copy
+         * constructed. If a copy throws, the copies made so far are destroyed.
+         */
+        CompactFiboHeap(const CompactFiboHeap& other)
+            : m_n(other.m_n)
+            , m_min(other.m_min)
+            , m_free(other.m_free)
+            , m_comp(other.m_comp)
+            , m_hot(other.m_hot)
+            , m_degree_table(other.m_degree_table)
+        {
+            if constexpr(std::is_trivially_copyable_v<ColdNode>)
+            {
+                m_cold = other.m_cold;
+            }
+            else
+            {
+                m_cold.resize(other.m_cold.size());
+                Index x = 0;
+                try
+                {
+                    for(; x < m_cold.size(); ++x)
+                    {
+                        if(inHeap(x))
+                        {
+                            ::new(static_cast<void*>(m_cold[x].storage)) ColdNode(other.cold(x));
+                        }
+                    }
+                }
+                catch(...)
+                {
+                    while(x-- > 0)
+                    {
+                        if(inHeap(x))
+                        {
+                            cold(x).~ColdNode();
+                        }
+                    }
+                    throw;
+                }
+            }
+        }
+
+        //! \brief Move Constructor, takes the arrays of \p other, which is left empty
+        CompactFiboHeap(CompactFiboHeap&& other) noexcept
+            : CompactFiboHeap()
+        {
+            swapNodes(other);
+        }
+
+        //! \brief Copy Assignment, \see CompactFiboHeap(const CompactFiboHeap&)
+        CompactFiboHeap& operator=(const CompactFiboHeap& other)
+        {
+            if(&other != this)
+            {
+                CompactFiboHeap copy(other);
+                swapNodes(copy);
+            }
+            return *this;
+        }
+
+        //! \brief Move Assignment, the elements of this heap are destroyed
+        CompactFiboHeap& operator=(CompactFiboHeap&& other) noexcept
+        {
+            if(&other != this)
+            {
+                clear();
+                swapNodes(other);
+            }
+            return *this;
+        }
+
+        //! \brief Destructor
+        ~CompactFiboHeap() noexcept
+        {
+            destroyCold();
+        }
+
+        //! \returns A deep copy of the heap, \see CompactFiboHeap(const CompactFiboHeap&)
+        CompactFiboHeap clone() const
+        {
+            return *this;
+        }
+
+        //! \returns If the heap has no elements
+        bool empty() const noexcept
+        {
+            return m_n == 0;
+        }
+
+        //! \returns The number of elements in the heap
+        size_t size() const noexcept
+        {
+            return m_n;
+        }
+
+        //! \returns The number of nodes the heap can hold without allocating
+        size_t capacity() const noexcept
+        {
+            return std::min(m_hot.capacity(), m_cold.capacity());
+        }
+
+        //! \brief Pre-allocates node storage so that \p n elements can be held without allocating
+        void reserve(size_t n)
+        {
+            m_hot.reserve(n);
+            m_cold.reserve(n);
+        }
+
+        //! \returns The index of the minimum node, kNil if the heap is empty
+        Index topIndex() const noexcept
+        {
+            return m_min;
+        }
+
+        //! \returns The priority at the top of the heap
+        const PriorityType& top() const
+        {
+            return m_hot[m_min].priority;
+        }
+
+        //! \returns The priority of node \p x
+        const PriorityType& priority(Index x) const
+        {
+            return m_hot[x].priority;
+        }
+
+        //! \returns The key of node \p x
+        const KeyType& key(Index x) const
+        {
+            return cold(x).key;
+        }
+
+        //! \returns The payload of node \p x
+        template <typename P = PayloadType>
+        std::enable_if_t<!std::is_void_v<P>, P&> payload(Index x)
+        {
+            return cold(x).payload;
+        }
+
+        //! Removes the minimum element
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            release(extractMin());
+        }
+
+        //! \brief Add a node to the heap, \returns its index
+        template <typename... Payload>
+        Index push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Add a node to the heap, constructing its payload in place, \returns its index
+        template <typename... Args>
+        Index emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            Index x;
+            if(m_free != kNil)
+            {
+                // The slot leaves the free list only once its node is constructed
+                x                 = m_free;
+                m_hot[x].priority = std::move(priority);
+                ::new(static_cast<void*>(m_cold[x].storage)) ColdNode(std::move(key), std::forward<Args>(args)...);
+                m_free = m_hot[x].right;
+            }
+            else
+            {
+                if(m_hot.size() >= kNil)
+                {
+                    throw std::length_error("CompactFiboHeap cannot hold more than 2^32 - 1 nodes");
+                }
+                x = static_cast<Index>(m_hot.size());
+                m_hot.push_back({std::move(priority), kNil, kNil, kNil, kNil, 0});
+                try
+                {
+                    m_cold.emplace_back();
+                    ::new(static_cast<void*>(m_cold[x].storage)) ColdNode(std::move(key), std::forward<Args>(args)...);
+                }
+                catch(...)
+                {
+                    m_cold.resize(x);
+                    m_hot.pop_back();
+                    throw;
+                }
+            }
+            insert(x);
+            return x;
+        }
+
+        //! \brief Decrease the priority of node \p x, \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+        bool decreasePriority(Index x, PriorityType new_priority)
+        {
+            if(m_comp(m_hot[x].priority, new_priority))
+            {
+                return false;
+            }
+            m_hot[x].priority = std::move(new_priority);
+            if(Index y = m_hot[x].p; y != kNil && m_comp(m_hot[x].priority, m_hot[y].priority))
+            {
+                cut(x, y);
+                cascadingCut(y);
+            }
+            if(m_comp(m_hot[x].priority, m_hot[m_min].priority))
+            {
+                m_min = x;
+            }
+            return true;
+        }
+
+        //! \brief Removes all the elements, keeping the storage
+        void clear() noexcept
+        {
+            destroyCold();
+            m_hot.clear();
+            m_cold.clear();
+            m_n    = 0;
+            m_min  = kNil;
+            m_free = kNil;
+        }
+
+       protected:
+        static std::uint32_t degree(const HotNode& x)
+        {
+            return x.degree_mark & ~kMarkBit;
+        }
+
+        void insert(Index x)
+        {
+            HotNode& hx    = m_hot[x];
+            hx.degree_mark = 0;
+            hx.child = hx.p = kNil;
+            if(m_min == kNil)
+            {
+                m_min = hx.left = hx.right = x;
+            }
+            else
+            {
+                spliceRoot(x);
+                if(m_comp(hx.priority, m_hot[m_min].priority))
+                {
+                    m_min = x;
+                }
+            }
+            ++m_n;
+        }
+
+        //! \brief Inserts \p x at the left of the minimum in the root list
+        void spliceRoot(Index x)
+        {
+            HotNode& hmin          = m_hot[m_min];
+            m_hot[hmin.left].right = x;
+            m_hot[x].left          = hmin.left;
+            hmin.left              = x;
+            m_hot[x].right         = m_min;
+        }
+
+        //! \returns The key and payload of \p x, which must be in the heap
+        ColdNode& cold(Index x) noexcept
+        {
+            return *std::launder(reinterpret_cast<ColdNode*>(m_cold[x].storage));
+        }
+
+        //! \see cold
+        const ColdNode& cold(Index x) const noexcept
+        {
+            return *std::launder(reinterpret_cast<const ColdNode*>(m_cold[x].storage));
+        }
+
+        //! \returns Whether slot \p x holds an element: the released slots, and no node of the heap, have a kNil left link
+        bool inHeap(Index x) const noexcept
+        {
+            return m_hot[x].left != kNil;
+        }
+
+        //! \brief Destroys the key and payload of \p x and returns its slot to the free list, threaded through the right links
+        void release(Index x)
+        {
+            cold(x).~ColdNode();
+            m_hot[x].left  = kNil;
+            m_hot[x].right = m_free;
+            m_free         = x;
+        }
+
+        //! \brief Destroys the keys and payloads of all the elements
+        void destroyCold() noexcept
+        {
+            if constexpr(!std::is_trivially_destructible_v<ColdNode>)
+            {
+                for(Index x = 0; x < m_cold.size(); ++x)
+                {
+                    if(inHeap(x))
+                    {
+                        cold(x).~ColdNode();
+                    }
+                }
+            }
+        }
+
+        //! \brief Exchanges the elements and storage of this heap and \p other in O(1)
+        void swapNodes(CompactFiboHeap& other) noexcept
+        {
+            std::swap(m_n, other.m_n);
+            std::swap(m_min, other.m_min);
+            std::swap(m_free, other.m_free);
+            std::swap(m_comp, other.m_comp);
+            m_hot.swap(other.m_hot);
+            m_cold.swap(other.m_cold);
+            std::swap(m_degree_table, other.m_degree_table);
+        }
+
+        //! \see FiboHeap::extractMin
+        Index extractMin()
+        {
+            Index z     = m_min;
+            HotNode& hz = m_hot[z];
+            if(Index x = hz.child; x != kNil)
+            {
+                Index last           = m_hot[x].left;
+                m_hot[last].right    = hz.right;
+                m_hot[hz.right].left = last;
+                hz.right             = x;
+                m_hot[x].left        = z;
+                hz.child             = kNil;
+            }
+            m_hot[hz.left].right = hz.right;
+            m_hot[hz.right].left = hz.left;
+            if(z == hz.right)
+            {
+                m_min = kNil;
+            }
+            else
+            {
+                m_min = hz.right;
+                consolidate();
+            }
+            --m_n;
+            return z;
+        }
+
+        //! \brief Makes \p y a child of \p x without touching the list \p y was in
+        void addChild(Index y, Index x)
+        {
+            HotNode& hx = m_hot[x];
+            HotNode& hy = m_hot[y];
+            if(hx.child != kNil)
+            {
+                HotNode& hc          = m_hot[hx.child];
+                m_hot[hc.left].right = y;
+                hy.left              = hc.left;
+                hc.left              = y;
+                hy.right             = hx.child;
+            }
+            else
+            {
+                hy.left = hy.right = hx.child = y;
+            }
+            hy.p = x;
+            ++hx.degree_mark;
+            hy.degree_mark &= ~kMarkBit;
+        }
+
+        //! \see FiboHeap::consolidate
+        void consolidate()
+        {
+            Index* A       = m_degree_table.data();
+            int max_degree = 0;
+            Index w        = m_min;
+            m_hot[m_hot[w].left].right = kNil;
+            while(w != kNil)
+            {
+                Index x    = w;
+                w          = m_hot[w].right;
+                m_hot[x].p = kNil;
+                int d      = static_cast<int>(degree(m_hot[x]));
+                while(A[d] != kNil)
+                {
+                    Index y = A[d];
+                    if(m_comp(m_hot[y].priority, m_hot[x].priority))
+                    {
+                        std::swap(x, y);
+                    }
+                    addChild(y, x);
+                    A[d] = kNil;
+                    ++d;
+                }
+                A[d]       = x;
+                max_degree = std::max(max_degree, d);
+            }
+            m_min = kNil;
+            for(int i = 0; i <= max_degree; ++i)
+            {
+                if(Index x = A[i]; x != kNil)
+                {
+                    A[i] = kNil;
+                    if(m_min == kNil)
+                    {
+                        m_min = m_hot[x].left = m_hot[x].right = x;
+                    }
+                    else
+                    {
+                        spliceRoot(x);
+                        if(m_comp(m_hot[x].priority, m_hot[m_min].priority))
+                        {
+                            m_min = x;
+                        }
+                    }
+                }
+            }
+        }
+
+        //! \see FiboHeap::cut
+        void cut(Index x, Index y)
+        {
+            HotNode& hx = m_hot[x];
+            HotNode& hy = m_hot[y];
+            if(hx.right == x)
+            {
+                hy.child = kNil;
+            }
+            else
+            {
+                m_hot[hx.right].left = hx.left;
+                m_hot[hx.left].right = hx.right;
+                if(hy.child == x)
+                {
+                    hy.child = hx.right;
+                }
+            }
+            --hy.degree_mark;
+            spliceRoot(x);
+            hx.p = kNil;
+            hx.degree_mark &= ~kMarkBit;
+        }
+
+        //! \see FiboHeap::cascadingCut
+        void cascadingCut(Index y)
+        {
+            for(Index z = m_hot[y].p; z != kNil; y = z, z = m_hot[y].p)
+            {
+                if(!(m_hot[y].degree_mark & kMarkBit))
+                {
+                    m_hot[y].degree_mark |= kMarkBit;
+                    return;
+                }
+                cut(y, z);
+            }
+        }
+
+        size_t m_n;
+        Index m_min;
+        //! Head of the list of released slots
+        Index m_free;
+        Comparator m_comp;
+        std::vector<HotNode> m_hot;
+        //! Keys and payloads, constructed only for the slots in the heap
+        std::vector<ColdSlot> m_cold;
+        std::array<Index, kMaxDegree> m_degree_table;
+    };
+}  // namespace fiboheap
@@ -0,0 +1,58 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <cstddef>
+#include <utility>
+
+// Local
+#include "fiboheap/fibo_node.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Node for an IndexedDaryQueue
+     *
+     * Exposes the same priority, key and payload members as FiboNode. The node
+     * knows its position in the heap array, so that it can be moved up or down
+     * the heap from its handle.
+     *
+     * \tparam PriorityType The type used to represent the priority of this node
+     * \tparam KeyType The type used for the identifier for the payload in this node
+     * \tparam PayloadType The data to store with this node, void for none
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType>
+    class DaryNode : public FiboPayload<PayloadType>
+    {
+       public:
+        template <typename... Args>
+        DaryNode(PriorityType priority, KeyType k, Args&&... args)
+            : FiboPayload<PayloadType>(std::forward<Args>(args)...)
+            , priority(std::move(priority))
+            , key(std::move(k))
+            , pos(0)
+        {}
+
+        PriorityType priority;
+        KeyType key;
+        //! Index of this node in the heap array
+        size_t pos;
+    };
+}  // namespace fiboheap
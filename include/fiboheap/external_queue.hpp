@@ -0,0 +1,566 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// External
+#include <robin_hood.h>
+
+// Local
+#include "fiboheap/fibo_queue.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief A keyed priority queue for frontiers larger than memory, spilling sorted runs to files
+     *
+     * Elements are inserted into a FiboQueue, the hot buffer. When it reaches
+     * its share of the memory budget, it is drained in order into a sorted run
+     * on disk. The top is the better of the hot buffer and of a k-way merge of
+     * the run heads, each run being read by large sequential blocks. Runs are
+     * merged level by level: when there are as many runs of a level as the
+     * budget has blocks for, they become one run of the next level.
+     *
+     * Decrease-key is lazy: a key that is not in the hot buffer is inserted
+     * again, even if older copies of it are on disk. Every copy carries a
+     * sequence number, and the keys that may have several copies get a record,
+     * found through a Bloom filter of the keys written to disk. Popping a key
+     * that has a record kills its other copies, the ones numbered before the
+     * pop, which are dropped when they come up or when runs are merged. A key
+     * can be pushed again after it was popped, as with the other queues.
+     *
+     * The records and the filter take most of the budget, as the lazy
+     * decreases are what makes the queue rewrite all its runs: when there are
+     * more records than fit, the runs are merged into one that keeps only the
+     * best copy of every key, and the records are dropped.
+     *
+     * \tparam PriorityType, KeyType Trivially copyable types, written as is to the runs
+     * \tparam Comp A comparison of priorities
+     * \tparam Store The fast store of the hot buffer
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename Comp = std::less<PriorityType>,
+              template <typename, typename> class Store = HashNodeStore>
+    class ExternalQueue
+    {
+        static_assert(std::is_trivially_copyable_v<PriorityType> && std::is_trivially_copyable_v<KeyType>,
+                      "ExternalQueue requires trivially copyable priorities and keys");
+
+        //! The payload of an element of the hot buffer is its sequence number
+        using HotQueue = FiboQueue<PriorityType, KeyType, std::uint64_t, Comp, Store>;
+
+        //! An element of a run
+        struct Entry
+        {
+            PriorityType priority;
+            KeyType key;
+            std::uint64_t seq;
+        };
+
+        //! A sorted run on disk, read one block at a time and removed with the object
+        class Run
+        {
+            //! Storage of an entry, so that keys need not be default constructible
+            struct Slot
+            {
+                alignas(Entry) unsigned char storage[sizeof(Entry)];
+            };
+
+           public:
+            Run(std::string path, std::uint64_t n, size_t block, int level)
+                : m_path(std::move(path))
+                , m_in(m_path, std::ios::binary)
+                , m_left(n)
+                , m_block(block)
+                , m_pos(0)
+                , m_level(level)
+            {
+                if(!m_in || !refill())
+                {
+                    std::remove(m_path.c_str());
+                    throw std::runtime_error("[Error]: cannot read " + m_path);
+                }
+            }
+
+            Run(const Run&) = delete;
+            Run& operator=(const Run&) = delete;
+
+            ~Run()
+            {
+                m_in.close();
+                std::remove(m_path.c_str());
+            }
+
+            //! \returns The current entry
+            const Entry& head() const noexcept
+            {
+                return *std::launder(reinterpret_cast<const Entry*>(m_buffer[m_pos].storage));
+            }
+
+            //! \returns The number of merges its entries went through
+            int level() const noexcept
+            {
+                return m_level;
+            }
+
+            //! \brief Moves to the next entry, \returns false if the run is exhausted
+            bool next()
+            {
+                return ++m_pos != m_buffer.size() || refill();
+            }
+
+           private:
+            bool refill()
+            {
+                size_t k = static_cast<size_t>(std::min<std::uint64_t>(m_left, m_block));
+                m_buffer.resize(k);
+                if(k != 0 && !m_in.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(k * sizeof(Entry))))
+                {
+                    throw std::runtime_error("[Error]: cannot read " + m_path);
+                }
+                m_left -= k;
+                m_pos = 0;
+                return k != 0;
+            }
+
+            std::string m_path;
+            std::ifstream m_in;
+            //! Entries not read yet
+            std::uint64_t m_left;
+            size_t m_block;
+            std::vector<Slot> m_buffer;
+            size_t m_pos;
+            int m_level;
+        };
+
+        using RunHeap = std::vector<std::unique_ptr<Run>>;
+
+       public:
+        //! Default size of the reads and writes of the runs
+        static constexpr size_t kDefaultBlockBytes = size_t(1) << 20;
+
+        //! Estimated memory of an element of the hot buffer: its node and about two store entries
+        static constexpr size_t kEntryBytes =
+            FiboNodePool<typename HotQueue::Node>::kSlotSize + 2 * (sizeof(KeyType) + sizeof(void*));
+
+        //! Estimated memory of the record of a key with several copies
+        static constexpr size_t kRecordBytes = 2 * (sizeof(KeyType) + sizeof(std::uint64_t));
+
+        /**!
+         * \brief Constructor
+         *
+         * A quarter of \p memory_budget goes to the hot buffer, which is
+         * reserved upfront, an eighth to the blocks of the runs, at least two of
+         * them, an eighth to the Bloom filter of the keys on disk and half to the
+         * records of the keys with several copies.
+         *
+         * \param memory_budget The memory of the queue in bytes
+         * \param directory Where the runs are written, the temporary directory by default
+         * \param block_bytes The size of the reads and writes of the runs
+         */
+        explicit ExternalQueue(size_t memory_budget,
+                               std::string directory = std::filesystem::temp_directory_path().string(),
+                               size_t block_bytes    = kDefaultBlockBytes)
+            : m_directory(std::move(directory))
+            , m_hot_capacity(std::max<size_t>(1, memory_budget / 4 / kEntryBytes))
+            , m_block(std::max<size_t>(1, block_bytes / sizeof(Entry)))
+            , m_fan_in(std::max<size_t>(2, memory_budget / 8 / std::max(block_bytes, sizeof(Entry))))
+            , m_bloom(std::max<size_t>(1, memory_budget / 8 / sizeof(std::uint64_t)), 0)
+            , m_record_capacity(std::max<size_t>(1, memory_budget / 2 / kRecordBytes))
+            , m_on_disk(0)
+            , m_spilled(0)
+            , m_next_seq(0)
+            , m_next_run(0)
+        {
+            std::random_device seed;
+            m_tag = std::to_string(seed()) + "_" + std::to_string(seed());
+            m_hot.reserve(m_hot_capacity);
+        }
+
+        ExternalQueue(const ExternalQueue&) = delete;
+        ExternalQueue& operator=(const ExternalQueue&) = delete;
+
+        //! \returns Whether the queue holds no element
+        bool empty() const noexcept
+        {
+            return m_hot.empty() && m_runs.empty();
+        }
+
+        //! \returns The number of entries held, in memory and on disk, dead copies of decreased keys included
+        std::uint64_t size() const noexcept
+        {
+            return m_hot.size() + m_on_disk;
+        }
+
+        //! \returns The number of runs on disk
+        size_t runs() const noexcept
+        {
+            return m_runs.size();
+        }
+
+        //! \returns The number of entries written to runs so far, merges included
+        std::uint64_t spilled() const noexcept
+        {
+            return m_spilled;
+        }
+
+        //! \returns The number of keys recorded as possibly having several copies
+        size_t records() const noexcept
+        {
+            return m_records.size();
+        }
+
+        //! \returns The best priority
+        const PriorityType& top() const
+        {
+            return hotFirst() ? m_hot.top() : m_runs.front()->head().priority;
+        }
+
+        //! \returns The key of the best priority
+        const KeyType& topKey() const
+        {
+            return hotFirst() ? m_hot.topNode()->key : m_runs.front()->head().key;
+        }
+
+        /**!
+         * \brief Pushes \p key if it is not in the hot buffer, otherwise decreases its priority if \p priority is better
+         *
+         * A key that is on disk is pushed again and Inserted is returned, even if
+         * its priority is not better: the better copy is popped and the other one
+         * dropped.
+         */
+        UpdateResult upsert(KeyType key, PriorityType priority)
+        {
+            bool on_disk = !m_runs.empty() && mayBeOnDisk(key);
+            UpdateResult result = m_hot.upsert(key, std::move(priority), m_next_seq++);
+            if(result != UpdateResult::Inserted)
+            {
+                return result;
+            }
+            if(on_disk && m_records.try_emplace(key, 0).second && m_records.size() > m_record_capacity)
+            {
+                compact();
+            }
+            if(m_hot.size() >= m_hot_capacity)
+            {
+                spill();
+            }
+            return result;
+        }
+
+        //! \brief Removes the top element, and the other copies of its key
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            if(hotFirst())
+            {
+                settle(m_hot.topNode()->key, false);
+                m_hot.pop();
+            }
+            else
+            {
+                settle(m_runs.front()->head().key, true);
+                advance(m_runs);
+            }
+            dropDead();
+        }
+
+        //! \brief Removes every element and the runs
+        void clear()
+        {
+            m_hot.clear();
+            m_runs.clear();
+            forgetDisk();
+        }
+
+       private:
+        //! \returns Whether the top is in the hot buffer, preferred on ties
+        bool hotFirst() const
+        {
+            return m_runs.empty() || (!m_hot.empty() && !m_comp(m_runs.front()->head().priority, m_hot.top()));
+        }
+
+        //! \returns The order of a heap of runs, the best head first
+        auto worse() const
+        {
+            return [this](const std::unique_ptr<Run>& a, const std::unique_ptr<Run>& b) {
+                return m_comp(b->head().priority, a->head().priority);
+            };
+        }
+
+        //! \brief Moves the best run of \p runs, the runs or those being merged, to its next entry, removing it when exhausted
+        void advance(RunHeap& runs)
+        {
+            std::pop_heap(runs.begin(), runs.end(), worse());
+            --m_on_disk;
+            if(runs.back()->next())
+            {
+                std::push_heap(runs.begin(), runs.end(), worse());
+            }
+            else
+            {
+                runs.pop_back();
+                if(&runs == &m_runs && m_runs.empty())
+                {
+                    forgetDisk();
+                }
+            }
+        }
+
+        //! \returns Whether \p e is a copy of a key popped after it was written
+        bool dead(const Entry& e) const
+        {
+            auto iter = m_records.find(e.key);
+            return iter != m_records.end() && e.seq < iter->second;
+        }
+
+        //! \brief Kills the other copies of \p key, being popped, and removes the one of the hot buffer if \p from_disk
+        void settle(const KeyType& key, bool from_disk)
+        {
+            if(auto iter = m_records.find(key); iter != m_records.end())
+            {
+                iter->second = m_next_seq;
+                if(from_disk)
+                {
+                    m_hot.erase(key);
+                }
+            }
+        }
+
+        //! \brief Skips the dead copies at the head of the runs, so that top() is live
+        void dropDead()
+        {
+            while(!m_runs.empty() && dead(m_runs.front()->head()))
+            {
+                advance(m_runs);
+            }
+        }
+
+        //! \brief Forgets the records and the filter, once no copy is left on disk
+        void forgetDisk()
+        {
+            m_records.clear();
+            std::fill(m_bloom.begin(), m_bloom.end(), 0);
+            m_on_disk = 0;
+        }
+
+        //! \brief Calls \p f on the bits of the Bloom filter of \p key
+        template <typename F>
+        void forEachBit(const KeyType& key, F&& f) const
+        {
+            std::uint64_t h     = robin_hood::hash<KeyType>()(key);
+            std::uint64_t step  = (h * 0x9e3779b97f4a7c15ULL) >> 32 | 1;
+            std::uint64_t nbits = m_bloom.size() * 64;
+            for(int i = 0; i < 3; ++i, h += step)
+            {
+                f(h % nbits);
+            }
+        }
+
+        void addToFilter(const KeyType& key)
+        {
+            forEachBit(key, [this](std::uint64_t b) { m_bloom[b >> 6] |= std::uint64_t(1) << (b & 63); });
+        }
+
+        //! \returns false if \p key was never written to a run since the disk was last empty
+        bool mayBeOnDisk(const KeyType& key) const
+        {
+            bool found = true;
+            forEachBit(key, [this, &found](std::uint64_t b) { found = found && (m_bloom[b >> 6] >> (b & 63) & 1); });
+            return found;
+        }
+
+        //! \brief Drains the hot buffer into a run of level 0, then merges the levels that are full
+        void spill()
+        {
+            writeRun(0, [this]() -> std::optional<Entry> {
+                if(m_hot.empty())
+                {
+                    return std::nullopt;
+                }
+                const auto* x = m_hot.topNode();
+                Entry e{x->priority, x->key, x->payload};
+                addToFilter(x->key);
+                m_hot.pop();
+                return e;
+            });
+            for(int level = 0;; ++level)
+            {
+                size_t count = std::count_if(m_runs.begin(), m_runs.end(), [level](const auto& r) { return r->level() == level; });
+                if(count < m_fan_in)
+                {
+                    break;
+                }
+                mergeRuns([level](const Run& r) { return r.level() == level; }, level + 1, [](const Entry&) { return true; });
+            }
+            dropDead();
+        }
+
+        /**!
+         * \brief Merges all the runs into one that holds a single copy of every key, then drops the records
+         *
+         * The merge meets the copies of a key in priority order: the first one is
+         * kept unless the copy in the hot buffer is at least as good, and the hot
+         * copy is removed otherwise. The others could only be popped after it,
+         * dead, so they are dropped as well.
+         */
+        void compact()
+        {
+            if(!m_runs.empty())
+            {
+                int level = 0;
+                for(const auto& r: m_runs)
+                {
+                    level = std::max(level, r->level() + 1);
+                }
+                std::fill(m_bloom.begin(), m_bloom.end(), 0);
+                robin_hood::unordered_flat_set<KeyType> seen;
+                mergeRuns([](const Run&) { return true; }, level, [&](const Entry& e) {
+                    if(m_records.find(e.key) != m_records.end())
+                    {
+                        if(!seen.insert(e.key).second)
+                        {
+                            return false;
+                        }
+                        if(const auto* x = m_hot.find(e.key); x != nullptr)
+                        {
+                            if(!m_comp(e.priority, x->priority))
+                            {
+                                return false;
+                            }
+                            m_hot.erase(e.key);
+                        }
+                    }
+                    addToFilter(e.key);
+                    return true;
+                });
+            }
+            m_records.clear();
+            dropDead();
+        }
+
+        /**!
+         * \brief Replaces the runs selected by \p select by their k-way merge, of level \p level, without the dead copies
+         *
+         * \param keep Called on every live entry, in order, \returns whether to write it
+         */
+        template <typename Select, typename Keep>
+        void mergeRuns(Select&& select, int level, Keep&& keep)
+        {
+            RunHeap runs;
+            auto first = std::partition(m_runs.begin(), m_runs.end(), [&select](const auto& r) { return !select(*r); });
+            std::move(first, m_runs.end(), std::back_inserter(runs));
+            m_runs.erase(first, m_runs.end());
+            std::make_heap(m_runs.begin(), m_runs.end(), worse());
+            std::make_heap(runs.begin(), runs.end(), worse());
+            writeRun(level, [&]() -> std::optional<Entry> {
+                while(!runs.empty())
+                {
+                    Entry e   = runs.front()->head();
+                    bool live = !dead(e);
+                    advance(runs);
+                    if(live && keep(e))
+                    {
+                        return e;
+                    }
+                }
+                return std::nullopt;
+            });
+        }
+
+        //! \brief Writes the entries returned by \p next until std::nullopt, in order, to a new run of level \p level
+        template <typename F>
+        void writeRun(int level, F&& next)
+        {
+            std::string path = (std::filesystem::path(m_directory) / ("fiboheap_" + m_tag + "_" + std::to_string(m_next_run++) + ".run")).string();
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            std::vector<Entry> buffer;
+            buffer.reserve(m_block);
+            std::uint64_t n = 0;
+            for(std::optional<Entry> e; (e = next()); ++n)
+            {
+                buffer.push_back(*e);
+                if(buffer.size() == m_block)
+                {
+                    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Entry)));
+                    buffer.clear();
+                }
+            }
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Entry)));
+            out.close();
+            if(!out || n == 0)
+            {
+                std::remove(path.c_str());
+                if(!out)
+                {
+                    throw std::runtime_error("[Error]: cannot write " + path);
+                }
+                return;
+            }
+            m_runs.reserve(m_runs.size() + 1);
+            m_runs.push_back(std::make_unique<Run>(std::move(path), n, m_block, level));
+            std::push_heap(m_runs.begin(), m_runs.end(), worse());
+            m_on_disk += n;
+            m_spilled += n;
+        }
+
+        Comp m_comp;
+        std::string m_directory;
+        //! Random part of the names of the runs, so that queues never share a file
+        std::string m_tag;
+        HotQueue m_hot;
+        size_t m_hot_capacity;
+        //! Entries per block of a run
+        size_t m_block;
+        //! Runs of a level merged at once
+        size_t m_fan_in;
+        //! Heap of the runs, the best head first
+        RunHeap m_runs;
+        //! Bloom filter of the keys written to runs since the disk was last empty
+        std::vector<std::uint64_t> m_bloom;
+        //! Keys that may have several copies, with the sequence number below which their copies are dead
+        robin_hood::unordered_flat_map<KeyType, std::uint64_t> m_records;
+        //! Number of records that triggers a compaction
+        size_t m_record_capacity;
+        std::uint64_t m_on_disk;
+        std::uint64_t m_spilled;
+        std::uint64_t m_next_seq;
+        std::uint64_t m_next_run;
+    };
+}  // namespace fiboheap
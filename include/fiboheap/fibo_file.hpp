@@ -0,0 +1,202 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fiboheap
+{
+    /**!
+     * \brief Header of a file written by FiboHeap::save
+     *
+     * The header is followed, at kDataOffset, by one record per node in the
+     * in-memory layout of the nodes, parents before children and every sibling
+     * list stored contiguously. The links of the records are addresses as if
+     * the records were at \p base, so that a file mapped at that address is
+     * used as is, and elsewhere only needs an offset added to its links.
+     */
+    struct FiboFileHeader
+    {
+        //! Format version, bumped on any change of the layout
+        static constexpr std::uint32_t kVersion = 1;
+        //! Written as is, reads differently on a machine of the other byte order
+        static constexpr std::uint32_t kByteOrder = 0x01020304;
+        //! Offset of the first record, a page boundary so that the records can be mapped in place
+        static constexpr std::uint64_t kDataOffset = 4096;
+
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        //! Size of a record, followed by the sizes of the priority, key and payload (0 for void)
+        std::uint64_t slot_size;
+        std::uint64_t priority_size;
+        std::uint64_t key_size;
+        std::uint64_t payload_size;
+        //! Number of records
+        std::uint64_t n;
+        //! Number of roots, the first records, the minimum first
+        std::uint64_t roots;
+        //! Address of the first record the links were written for
+        std::uint64_t base;
+
+        //! \returns Whether \p magic, the version and the byte order are the ones of this build
+        bool valid() const noexcept
+        {
+            return std::memcmp(magic, "FIBOHEAP", sizeof(magic)) == 0 && version == kVersion
+                   && byte_order == kByteOrder;
+        }
+
+        //! \returns The address a file is preferably mapped at, that of the records of a saved heap
+        static std::uint64_t preferredBase() noexcept
+        {
+            // An address of the user space away from the usual heap and mapping areas on 64 bit systems
+            return sizeof(void*) == 8 ? std::uint64_t(0x5f0000000000) + kDataOffset : kDataOffset;
+        }
+    };
+
+    /**!
+     * \brief Records of a file written by FiboHeap::save, mapped or read into memory
+     *
+     * On POSIX systems the file is mapped privately: pages are only read from
+     * the file when touched and written pages are copied, the file itself is
+     * never modified. Elsewhere, or if the file cannot be mapped, it is read
+     * into an allocated buffer.
+     */
+    class FiboFile
+    {
+       public:
+        //! \brief Maps or reads the file \p path, throws std::runtime_error if it is not a valid file
+        explicit FiboFile(const std::string& path)
+            : m_data(nullptr)
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if(!in)
+            {
+                throw std::runtime_error("[Error]: cannot open " + path);
+            }
+            std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+            in.seekg(0);
+            if(size < FiboFileHeader::kDataOffset || !in.read(reinterpret_cast<char*>(&m_header), sizeof(m_header))
+               || !m_header.valid() || m_header.slot_size == 0
+               || (size - FiboFileHeader::kDataOffset) / m_header.slot_size < m_header.n)
+            {
+                throw std::runtime_error("[Error]: " + path + " is not a FiboHeap file of this version");
+            }
+#if defined(__unix__) || defined(__APPLE__)
+            if(int fd = ::open(path.c_str(), O_RDONLY); fd >= 0)
+            {
+                void* hint = reinterpret_cast<void*>(static_cast<std::uintptr_t>(m_header.base - FiboFileHeader::kDataOffset));
+                void* map  = ::mmap(hint, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if(map != MAP_FAILED)
+                {
+                    m_keeper = std::shared_ptr<void>(map, [size](void* p) { ::munmap(p, size); });
+                    m_data   = static_cast<char*>(map) + FiboFileHeader::kDataOffset;
+                    return;
+                }
+            }
+#endif
+            m_keeper = std::shared_ptr<void>(::operator new(size), [](void* p) { ::operator delete(p); });
+            if(!in.seekg(0) || !in.read(static_cast<char*>(m_keeper.get()), static_cast<std::streamsize>(size)))
+            {
+                throw std::runtime_error("[Error]: cannot read " + path);
+            }
+            m_data = static_cast<char*>(m_keeper.get()) + FiboFileHeader::kDataOffset;
+        }
+
+        //! \returns The header of the file
+        const FiboFileHeader& header() const noexcept
+        {
+            return m_header;
+        }
+
+        //! \returns The first record, aligned for any fundamental type
+        void* data() const noexcept
+        {
+            return m_data;
+        }
+
+        //! \returns The owner of the records, to keep them alive
+        const std::shared_ptr<void>& keeper() const noexcept
+        {
+            return m_keeper;
+        }
+
+        /**!
+         * \brief Writes \p header then the records output by \p records to \p path
+         *
+         * \param records Called with a function that writes the bytes of a record
+         */
+        template <typename F>
+        static void write(const std::string& path, FiboFileHeader header, F&& records)
+        {
+            std::memcpy(header.magic, "FIBOHEAP", sizeof(header.magic));
+            header.version    = FiboFileHeader::kVersion;
+            header.byte_order = FiboFileHeader::kByteOrder;
+            // Written aside then renamed, a file still mapped by a loaded heap must not be truncated under it
+            const std::string tmp = path + ".tmp";
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            char page[FiboFileHeader::kDataOffset] = {};
+            std::memcpy(page, &header, sizeof(header));
+            out.write(page, sizeof(page));
+            // Records are small, they are gathered into large writes
+            std::vector<char> buffer;
+            buffer.reserve(kWriteBuffer);
+            records([&out, &buffer](const void* record, size_t size) {
+                if(buffer.size() + size > kWriteBuffer)
+                {
+                    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+                buffer.insert(buffer.end(), static_cast<const char*>(record), static_cast<const char*>(record) + size);
+            });
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.close();
+            if(!out || std::rename(tmp.c_str(), path.c_str()) != 0)
+            {
+                std::remove(tmp.c_str());
+                throw std::runtime_error("[Error]: cannot write " + path);
+            }
+        }
+
+       private:
+        //! Size of the writes of write()
+        static constexpr size_t kWriteBuffer = size_t(1) << 20;
+
+        FiboFileHeader m_header;
+        void* m_data;
+        std::shared_ptr<void> m_keeper;
+    };
+}  // namespace fiboheap
@@ -19,32 +19,248 @@
 #pragma once
 
 // Global
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // Local
+#include "fiboheap/fibo_file.hpp"
 #include "fiboheap/fibo_node.hpp"
+#include "fiboheap/fibo_node_pool.hpp"
+#include "fiboheap/fibo_stats.hpp"
 
 namespace fiboheap
 {
-    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comparator = std::less<PriorityType>>
-    class FiboHeap
+    //! \brief Output iterator that drops whatever is written to it
+    struct DiscardIterator
+    {
+        DiscardIterator& operator*()
+        {
+            return *this;
+        }
+
+        DiscardIterator& operator++(int)
+        {
+            return *this;
+        }
+
+        template <typename T>
+        DiscardIterator& operator=(const T&)
+        {
+            return *this;
+        }
+    };
+
+    /**!
+     * \brief Fibonacci heap of nodes with a priority, a key and a payload
+     *
+     * \tparam PriorityType The type used to represent the priority of the nodes
+     * \tparam KeyType The type used for the identifier of the payloads
+     * \tparam PayloadType The data to store with each node, void for none
+     * \tparam Comparator A comparison of priorities
+     * \tparam Stats The statistics policy, NoStats (free) or FiboStats, available through stats()
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              typename Comparator = std::less<PriorityType>,
+              typename Stats = NoStats>
+    class FiboHeap : protected Stats
     {
        protected:
         using Node = FiboNode<PriorityType, KeyType, PayloadType>;
 
+       public:
+        //! Element moved out of the heap by popN, (priority, key[, payload])
+        using value_type = std::conditional_t<std::is_void_v<PayloadType>,
+                                              std::tuple<PriorityType, KeyType>,
+                                              std::tuple<PriorityType, KeyType, PayloadType>>;
+
+       protected:
+        //! Bound on the degree of any node: D(n) <= log_phi(n) < 93 for any 64 bit size
+        static constexpr int kMaxDegree = 96;
+
+        //! How many entries ahead decreasePriorityBatch() prefetches the nodes, their parents half as far
+        static constexpr std::ptrdiff_t kPrefetchDistance = 8;
+
        public:
         //! \brief Default Constructor
         FiboHeap()
             : m_n(0)
             , m_min(nullptr)
+            , m_budget(0)
+            , m_tabled(false)
+            , m_max_degree(0)
         {}
 
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        FiboHeap(InputIt first, InputIt last)
+            : FiboHeap()
+        {
+            push_range(first, last);
+        }
+
+        /**!
+         * \brief Copy Constructor
+         *
+         * The nodes are copied in one sequential pass over the slabs of \p other
+         * and their links rebased, so the copy has the same shape (degrees, marks,
+         * consolidation mode) and the same memory layout.
+         */
+        FiboHeap(const FiboHeap& other)
+            : FiboHeap()
+        {
+            copyNodes(other);
+        }
+
+        //! \brief Copy Assignment, \see FiboHeap(const FiboHeap&)
+        FiboHeap& operator=(const FiboHeap& other)
+        {
+            if(&other != this)
+            {
+                clear();
+                copyNodes(other);
+            }
+            return *this;
+        }
+
+        /**!
+         * \brief Move Constructor
+         *
+         * Takes the node pool of \p other as a whole: no node is copied and the
+         * nodes keep their addresses. \p other is left empty.
+         */
+        FiboHeap(FiboHeap&& other) noexcept
+            : FiboHeap()
+        {
+            swapNodes(other);
+        }
+
+        //! \brief Move Assignment, the nodes of this heap are destroyed, \see FiboHeap(FiboHeap&&)
+        FiboHeap& operator=(FiboHeap&& other) noexcept
+        {
+            if(&other != this)
+            {
+                clear();
+                swapNodes(other);
+            }
+            return *this;
+        }
+
+        //! \returns A deep copy of the heap, \see FiboHeap(const FiboHeap&)
+        FiboHeap clone() const
+        {
+            return FiboHeap(*this);
+        }
+
+        /**!
+         * \brief Writes the heap to the file \p path in a binary format that keeps the shape of the forest
+         *
+         * The nodes are written in their in-memory layout, parents first and
+         * every sibling list contiguously, \see FiboFileHeader. A file is meant to
+         * be loaded by a build with the same types and node layout. Throws
+         * std::runtime_error if the file cannot be written.
+         */
+        void save(const std::string& path) const
+        {
+            static_assert(std::is_trivially_copyable_v<Node>, "save requires trivially copyable priorities, keys and payloads");
+            constexpr size_t kSlotSize = FiboNodePool<Node>::kSlotSize;
+            std::vector<const Node*> roots;
+            if(!m_tabled)
+            {
+                forEachSibling(m_min, [&roots](const Node* x) { roots.push_back(x); });
+            }
+            else if(m_min != nullptr)
+            {
+                roots.push_back(m_min);
+                for(int d = 0; d <= m_max_degree; ++d)
+                {
+                    if(m_degree_table[d] != nullptr && m_degree_table[d] != m_min)
+                    {
+                        roots.push_back(m_degree_table[d]);
+                    }
+                }
+                std::copy_if(m_pending.begin(), m_pending.end(), std::back_inserter(roots), [this](const Node* x) { return x != m_min; });
+            }
+            FiboFileHeader header{};
+            header.slot_size     = kSlotSize;
+            header.priority_size = sizeof(PriorityType);
+            header.key_size      = sizeof(KeyType);
+            header.payload_size  = payloadSize();
+            header.n             = m_n;
+            header.roots         = roots.size();
+            header.base          = FiboFileHeader::preferredBase();
+            auto address = [&header](std::uint64_t i) {
+                return reinterpret_cast<Node*>(static_cast<std::uintptr_t>(header.base + i * kSlotSize));
+            };
+            FiboFile::write(path, header, [&](auto&& write) {
+                alignas(Node) unsigned char record[kSlotSize] = {};
+                Node* r = reinterpret_cast<Node*>(record);
+                // Child lists left to write, in the order of their records: first node, index of the first, index of the parent
+                std::vector<std::tuple<const Node*, std::uint64_t, std::uint64_t>> lists;
+                std::uint64_t next = roots.size();
+                // Writes x, the k-th node of a list of len nodes starting at index first
+                auto emit = [&](const Node* x, std::uint64_t k, std::uint64_t len, std::uint64_t first, Node* p) {
+                    std::memcpy(record, static_cast<const void*>(x), sizeof(Node));
+                    r->p     = p;
+                    r->left  = address(first + (k + len - 1) % len);
+                    r->right = address(first + (k + 1) % len);
+                    r->child = nullptr;
+                    if(x->child != nullptr)
+                    {
+                        r->child = address(next);
+                        lists.emplace_back(x->child, next, first + k);
+                        next += static_cast<std::uint64_t>(x->degree);
+                    }
+                    write(record, kSlotSize);
+                };
+                for(size_t k = 0; k < roots.size(); ++k)
+                {
+                    emit(roots[k], k, roots.size(), 0, nullptr);
+                }
+                for(size_t l = 0; l < lists.size(); ++l)
+                {
+                    auto [child, first, parent] = lists[l];
+                    std::uint64_t len           = static_cast<std::uint64_t>(child->p->degree);
+                    std::uint64_t k             = 0;
+                    forEachSibling(child, [&](const Node* x) { emit(x, k++, len, first, address(parent)); });
+                }
+            });
+        }
+
+        /**!
+         * \brief Replaces the content of the heap by that of the file \p path written by save()
+         *
+         * The records become the nodes of the heap without being parsed or
+         * copied: the file is mapped into memory (\see FiboFile) and, when it
+         * could not be mapped at the address it was written for, the links of
+         * the records are offset in one sequential pass. The heap keeps its
+         * consolidation budget. Files are trusted, a file of another node type or
+         * version throws std::runtime_error.
+         */
+        void load(const std::string& path)
+        {
+            loadNodes(path, [](Node*) {});
+        }
+
         //! \brief Destructor
         ~FiboHeap() noexcept
         {
-            deleteNodes(m_min);
+            destroyNodes();
         }
 
         //! \returns If the heap has no elements
@@ -59,6 +275,75 @@ namespace fiboheap
             return m_n;
         }
 
+        //! \returns The number of nodes the heap can hold without allocating
+        size_t capacity() const noexcept
+        {
+            return m_pool.capacity();
+        }
+
+        //! \brief Pre-allocates node storage so that \p n elements can be held without allocating
+        void reserve(size_t n)
+        {
+            m_pool.reserve(n);
+        }
+
+        /**!
+         * \brief Removes all the elements, keeping the node storage and the consolidation budget
+         *
+         * The forest is torn down without recursion and without consolidating,
+         * and its nodes are not returned one by one: the pool starts over from
+         * its first slab. With trivially destructible priorities, keys and
+         * payloads no node is visited at all and clearing takes O(1). Node
+         * handles are invalidated.
+         */
+        void clear() noexcept
+        {
+            destroyNodes();
+            reset();
+        }
+
+        /**!
+         * \brief Sets how much consolidation work is done per operation
+         *
+         * With a budget of 0 (eager mode, the default) the root list is consolidated
+         * as a whole by the extraction that follows, so a pop after a burst of n
+         * pushes costs O(n). With a positive budget (incremental mode) the roots
+         * stay in the degree table between operations, every push and decrease
+         * links up to \p budget of the new roots into it, and a pop only links the
+         * children of the minimum and what is left: O(log n) as long as the budget
+         * keeps up with the roots being created. top() is exact in both modes.
+         */
+        void setConsolidationBudget(size_t budget)
+        {
+            m_budget = budget;
+            if(m_budget == 0)
+            {
+                settle();
+            }
+            else
+            {
+                tabulate();
+            }
+        }
+
+        //! \returns The number of roots linked per operation, 0 in eager mode
+        size_t consolidationBudget() const noexcept
+        {
+            return m_budget;
+        }
+
+        //! \returns The statistics policy, FiboStats::snapshot() gives its counters
+        const Stats& stats() const noexcept
+        {
+            return *this;
+        }
+
+        //! \see stats
+        Stats& stats() noexcept
+        {
+            return *this;
+        }
+
         //! \returns The minimum node of the heap
         Node* minimum() const
         {
@@ -71,6 +356,12 @@ namespace fiboheap
             return minimum();
         }
 
+        //! \returns The priority at the top of the tree
+        const PriorityType& top() const
+        {
+            return m_min->priority;
+        }
+
         //! Removes the minimum element
         void pop()
         {
@@ -78,12 +369,352 @@ namespace fiboheap
             {
                 return;
             }
+            [[maybe_unused]] auto timer = Stats::timer(StatsOp::Pop);
             if(Node* x = extractMin(); x != nullptr)
             {
-                delete x;
+                m_pool.destroy(x);
+            }
+        }
+
+        /**!
+         * \brief Removes the \p k minimum elements, rebuilding the root list once
+         *
+         * \param k The number of elements to remove, clamped to size()
+         * \param out Receives the removed elements as value_type, in priority order
+         *
+         * \returns The output iterator past the last written element
+         */
+        template <typename OutputIt>
+        OutputIt popN(size_t k, OutputIt out)
+        {
+            extractMinN(k, [&](Node* x) { *out++ = release(x); });
+            return out;
+        }
+
+        /**!
+         * \brief Add a node to the heap
+         *
+         * \param priority Value representing the significance of the stored payload
+         * \param key Value identifying the stored payload
+         * \param payload Data to put into the Heap (omitted when PayloadType is void)
+         *
+         * \returns A pointer to the HeapNode that was recently added to the Heap
+         */
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        /**!
+         * \brief Add a node to the heap, constructing its payload in place
+         *
+         * \param priority Value representing the significance of the stored payload
+         * \param key Value identifying the stored payload
+         * \param args Arguments forwarded to the constructor of the payload
+         *
+         * \returns A pointer to the HeapNode that was recently added to the Heap
+         */
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            [[maybe_unused]] auto timer = Stats::timer(StatsOp::Push);
+            Node* x = createNode(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            insert(x);
+            return x;
+        }
+
+        /**!
+         * \brief Add a range of elements to the heap in a single pass
+         *
+         * The nodes are allocated in one block when the size of the range is known,
+         * chained together and spliced into the root list at once, and the minimum
+         * is updated once at the end.
+         *
+         * \param first, last The range of tuple-like elements (priority, key[, payload])
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            insertRange(first, last, [](Node*) {});
+        }
+
+        /**!
+         * \brief Moves all the elements of \p other into this heap
+         *
+         * union_fibheap(H1,H2)
+         * 1. H = MAKE-FIB-HEAP()
+         * 2. H.min = H1.min
+         * 3. concatenate the root list of H2 with the root list of H
+         * 4. if (H1.min == NIL) or (H2.min != NIL and H2.min.key < H1.min.key)
+         * 5. 	H.min = H2.min
+         * 6. H.n = H1.n + H2.n
+         * 7. return H
+         *
+         * This heap plays the part of H1 and H. The root lists are spliced in O(1)
+         * and the slabs of \p other change owner without being copied. Node handles
+         * of \p other stay valid and now belong to this heap, \p other is left empty.
+         * In incremental mode the degree tables of both heaps are settled first.
+         */
+        void meld(FiboHeap&& other)
+        {
+            if(&other == this)
+            {
+                return;
+            }
+            settle();
+            other.settle();
+            m_pool.merge(std::move(other.m_pool));
+            // 2
+            if(Node* min2 = other.m_min; min2 != nullptr)
+            {
+                // 3
+                if(m_min != nullptr)
+                {
+                    Node* last2        = min2->left;
+                    m_min->left->right = min2;
+                    min2->left         = m_min->left;
+                    m_min->left        = last2;
+                    last2->right       = m_min;
+                }
+                // 4
+                if(m_min == nullptr || m_comp(min2->priority, m_min->priority))
+                {
+                    // 5
+                    m_min = min2;
+                }
             }
+            // 6
+            m_n += other.m_n;
+            other.m_min = nullptr;
+            other.m_n   = 0;
+        }
+
+        //! \brief Melds \p h1 and \p h2 into a new heap, leaving them empty, \see meld
+        static FiboHeap* unionFiboHeap(FiboHeap* h1, FiboHeap* h2)
+        {
+            // 1
+            FiboHeap* h = new FiboHeap();
+            // 2 - 6
+            h->meld(std::move(*h1));
+            h->meld(std::move(*h2));
+            // 7
+            return h;
         }
 
+        /**!
+         * \brief Removes \p x from the heap and destroys it
+         *
+         * \p x is cut from its parent as if its priority had been decreased to minus
+         * infinity and its children become roots, but it is unlinked where it is
+         * instead of going through extractMin(). The roots are only consolidated
+         * when \p x was the minimum.
+         */
+        void erase(Node* x)
+        {
+            [[maybe_unused]] auto timer = Stats::timer(StatsOp::Erase);
+            isolate(x);
+            // x is a root of degree 0, held by the root list or by m_pending
+            if(m_tabled)
+            {
+                // isolate() queued it last unless it was already pending
+                auto it = std::find(m_pending.rbegin(), m_pending.rend(), x);
+                *it     = m_pending.back();
+                m_pending.pop_back();
+            }
+            else
+            {
+                x->left->right = x->right;
+                x->right->left = x->left;
+            }
+            --m_n;
+            if(x == m_min)
+            {
+                m_min = m_tabled || x->right == x ? nullptr : x->right;
+                restoreMin();
+            }
+            else
+            {
+                drain(m_budget);
+            }
+            m_pool.destroy(x);
+        }
+
+        //! \see erase
+        void removeNode(Node* x)
+        {
+            erase(x);
+        }
+
+        /**!
+         * \brief Sets the priority of a node in the heap, in either direction
+         *
+         * A decrease is a decreasePriority(). On an increase, if a child of \p x
+         * now has a better priority, \p x is cut from its parent and its children
+         * are cut from it in place, so that \p x becomes a root of degree 0. The
+         * roots are only consolidated when \p x was the minimum.
+         */
+        void updatePriority(Node* x, PriorityType new_priority)
+        {
+            [[maybe_unused]] auto timer = Stats::timer(StatsOp::Update);
+            if(!m_comp(x->priority, new_priority))
+            {
+                decreasePriority(x, std::move(new_priority));
+                return;
+            }
+            x->priority = std::move(new_priority);
+            if(Node* c = x->child; c != nullptr)
+            {
+                Node* w = c;
+                do
+                {
+                    if(m_comp(w->priority, x->priority))
+                    {
+                        isolate(x);
+                        break;
+                    }
+                    w = w->right;
+                } while(w != c);
+            }
+            if(x == m_min)
+            {
+                restoreMin();
+            }
+            else
+            {
+                drain(m_budget);
+            }
+        }
+
+        /**!
+         * \brief Decrease the priority of a node in the heap
+         *
+         * decrease_key(x,k)
+         * 1. if k > x.key
+         * 2. 	error "new key is greater than current key"
+         * 3. x.key = k
+         * 4. y = x.p
+         * 5. if y != NIL and x.key < y.key
+         * 6. 	CUT(H,x,y)
+         * 7. 	CASCADING-CUT(H,y)
+         * 8. if x.key < H.min.key
+         * 9. 	H.min = x
+         *
+         * \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+         */
+        bool decreasePriority(Node* x, PriorityType new_priority)
+        {
+            [[maybe_unused]] auto timer = Stats::timer(StatsOp::Decrease);
+            // 1
+            if(m_comp(x->priority, new_priority))
+            {
+                // 2
+                return false;
+            }
+            // 3
+            x->priority = std::move(new_priority);
+            // 4, 5
+            if(Node* y = x->p; y != nullptr && m_comp(x->priority, y->priority))
+            {
+                // 6
+                cut(x, y);
+                // 7
+                cascadingCut(y);
+            }
+            // 8
+            if(m_comp(x->priority, m_min->priority))
+            {
+                // 9
+                m_min = x;
+            }
+            drain(m_budget);
+            return true;
+        }
+
+        /**!
+         * \brief Decrease the priority of several nodes at once
+         *
+         * All the affected nodes are cut first, the cascading cut then runs once per
+         * parent that lost children (a parent that lost several is cut right away,
+         * as if it had been marked) and the minimum is updated once at the end.
+         * Over a random access range, the node kPrefetchDistance entries ahead and
+         * the parent of the one half as far are prefetched, so that their cache
+         * misses overlap with the cuts.
+         *
+         * \param first, last A range of pairs (Node*, new priority)
+         * \param rejected Receives the nodes whose new priority was greater than the current one
+         *
+         * \returns The number of nodes whose priority was decreased
+         */
+        template <typename InputIt, typename RejectIt>
+        size_t decreasePriorityBatch(InputIt first, InputIt last, RejectIt rejected)
+        {
+            constexpr bool kRandomAccess = std::is_base_of_v<std::random_access_iterator_tag,
+                                                             typename std::iterator_traits<InputIt>::iterator_category>;
+            size_t decreased = 0;
+            Node* best       = nullptr;
+            for(; first != last; ++first)
+            {
+                if constexpr(kRandomAccess)
+                {
+                    std::ptrdiff_t ahead = last - first;
+                    if(ahead > kPrefetchDistance)
+                    {
+                        prefetch(std::get<0>(first[kPrefetchDistance]));
+                    }
+                    if(ahead > kPrefetchDistance / 2)
+                    {
+                        prefetch(std::get<0>(first[kPrefetchDistance / 2])->p);
+                    }
+                }
+                Node* x = std::get<0>(*first);
+                if(m_comp(x->priority, std::get<1>(*first)))
+                {
+                    *rejected++ = x;
+                    continue;
+                }
+                x->priority = std::get<1>(*first);
+                ++decreased;
+                if(Node* y = x->p; y != nullptr && m_comp(x->priority, y->priority))
+                {
+                    cut(x, y);
+                    m_cut_parents.push_back(y);
+                }
+                if(best == nullptr || m_comp(x->priority, best->priority))
+                {
+                    best = x;
+                }
+            }
+            std::sort(m_cut_parents.begin(), m_cut_parents.end());
+            for(auto it = m_cut_parents.begin(); it != m_cut_parents.end();)
+            {
+                Node* y = *it;
+                auto next = std::upper_bound(it, m_cut_parents.end(), y);
+                if(next - it > 1)
+                {
+                    y->mark = true;
+                }
+                cascadingCut(y);
+                it = next;
+            }
+            m_cut_parents.clear();
+            if(best != nullptr && m_comp(best->priority, m_min->priority))
+            {
+                m_min = best;
+            }
+            drain(m_budget);
+            return decreased;
+        }
+
+        //! \see decreasePriorityBatch, rejected nodes are ignored
+        template <typename InputIt>
+        size_t decreasePriorityBatch(InputIt first, InputIt last)
+        {
+            return decreasePriorityBatch(first, last, DiscardIterator());
+        }
+
+       protected:
         /**!
          * \brief Inserts a node into the Heap
          *
@@ -108,6 +739,19 @@ namespace fiboheap
             x->child = x->p = nullptr;
             // 4
             x->mark = false;
+            if(m_budget != 0)
+            {
+                // 8 - 10 (the root is queued for the degree table)
+                tabulate();
+                m_pending.push_back(x);
+                if(m_min == nullptr || m_comp(x->priority, m_min->priority))
+                {
+                    m_min = x;
+                }
+                ++m_n;
+                drain(m_budget);
+                return;
+            }
             if(m_min == nullptr)
             {
                 // 6,7
@@ -131,113 +775,166 @@ namespace fiboheap
             ++ m_n;
         }
 
-        /**!
-         * \brief Add a node to the heap
-         *
-         * \param priority Value representing the significance of the stored payload
-         * \param key Value identifying the stored payload
-         * \param payload Data to put into the Heap
-         *
-         * \returns A pointer to the HeapNode that was recently added to the Heap
-         */
-        Node* push(PriorityType priority, KeyType key, std::shared_ptr<PayloadType> payload = nullptr)
+        //! \brief Creates a node from \p args in the pool
+        template <typename... Args>
+        Node* createNode(Args&&... args)
         {
-            Node* x = new Node(std::move(priority), std::move(key), payload);
-            insert(x);
+            size_t capacity = m_pool.capacity();
+            Node* x         = m_pool.create(std::forward<Args>(args)...);
+            Stats::onAllocate(m_pool.capacity() != capacity);
             return x;
         }
 
+        //! \brief Moves the content of \p x out and frees it
+        value_type release(Node* x)
+        {
+            value_type v = [x]() {
+                if constexpr(std::is_void_v<PayloadType>)
+                {
+                    return value_type(std::move(x->priority), std::move(x->key));
+                }
+                else
+                {
+                    return value_type(std::move(x->priority), std::move(x->key), std::move(x->payload));
+                }
+            }();
+            m_pool.destroy(x);
+            return v;
+        }
+
         /**!
-         * \brief
+         * \brief Extracts the \p k minimum nodes, in order, consolidating once
          *
-         * union_fibheap(H1,H2)
-         * 1. H = MAKE-FIB-HEAP()
-         * 2. H.min = H1.min
-         * 3. concatenate the root list of H2 with the root list of H
-         * 4. if (H1.min == NIL) or (H2.min != NIL and H2.min.key < H1.min.key)
-         * 5. 	H.min = H2.min
-         * 6. H.n = H1.n + H2.n
-         * 7. return H
+         * The roots are linked into the degree table once. Every extraction then
+         * takes the minimum out of the table and links its children back in, and
+         * the root list is only rebuilt from the table at the end of the batch.
+         *
+         * \param onNode Called with every extracted node and takes ownership of it
          */
-        static FiboHeap* unionFiboHeap(FiboHeap* h1, FiboHeap* h2)
+        template <typename OnNode>
+        void extractMinN(size_t k, OnNode&& onNode)
         {
-            // 1
-            FiboHeap* h = new FiboHeap();
-            // 2
-            h->m_min = h1->m_min;
-            // 3
-            if(h->min != nullptr && h2->min != nullptr)
+            k = std::min(k, m_n);
+            if(k == 0)
             {
-                h->min->right->left  = h2->min->left;
-                h2->min->left->right = h->min->right;
-                h->min->right        = h2->min;
-                h2->min->left        = h->min;
+                return;
             }
-            // 4
-            if(h1->min == nullptr || (h2->min != nullptr && h1->m_comp(h2->min->priority, h1->min->priority)))
+            settle();
+            Node** A       = m_degree_table.data();
+            int max_degree = linkIntoDegreeTable(m_min, 0);
+            for(size_t i = 0; i < k; ++i)
             {
-                h->m_min = h2->m_min;
+                Node* z = nullptr;
+                for(int d = 0; d <= max_degree; ++d)
+                {
+                    if(A[d] != nullptr && (z == nullptr || m_comp(A[d]->priority, z->priority)))
+                    {
+                        z = A[d];
+                    }
+                }
+                A[z->degree] = nullptr;
+                if(Node* c = z->child; c != nullptr)
+                {
+                    z->child   = nullptr;
+                    max_degree = linkIntoDegreeTable(c, max_degree);
+                }
+                --m_n;
+                onNode(z);
             }
-            h->m_n = h1->m_n + h2->m_n;
-            return h;
-        }
-
-        //! \brief Set to infinity so that it hits the top of the heap, then easily remove
-        void removeNode(Node* x)
-        {
-            decreasePriority(x, std::numeric_limits<PriorityType>::min());
-            delete extractMin();
+            rebuildRootList(max_degree);
         }
 
         /**!
-         * \brief Decrease the priority of a node in the heap
+         * \brief Creates a node for each element of [first, last) and splices them into the root list
          *
-         * decrease_key(x,k)
-         * 1. if k > x.key
-         * 2. 	error "new key is greater than current key"
-         * 3. x.key = k
-         * 4. y = x.p
-         * 5. if y != NIL and x.key < y.key
-         * 6. 	CUT(H,x,y)
-         * 7. 	CASCADING-CUT(H,y)
-         * 8. if x.key < H.min.key
-         * 9. 	H.min = x
+         * \param onNode Called with every created node
          */
-        void decreasePriority(Node* x, PriorityType new_priority)
+        template <typename InputIt, typename OnNode>
+        void insertRange(InputIt first, InputIt last, OnNode&& onNode)
         {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                m_pool.reserve(m_pool.size() + static_cast<size_t>(std::distance(first, last)));
+            }
+            if(m_budget != 0)
+            {
+                // Each element gets its share of the linking, there is no root list to splice into
+                auto create = [this](auto&&... args) {
+                    return createNode(std::forward<decltype(args)>(args)...);
+                };
+                for(; first != last; ++first)
+                {
+                    Node* x = std::apply(create, *first);
+                    insert(x);
+                    onNode(x);
+                }
+                return;
+            }
+            Node* head   = nullptr;
+            Node* tail   = nullptr;
+            Node* best   = nullptr;
+            size_t count = 0;
+            auto create = [this](auto&&... args) {
+                return createNode(std::forward<decltype(args)>(args)...);
+            };
+            // Whatever was chained so far is spliced in, even if an element throws
+            auto splice = [&]() {
+                if(head == nullptr)
+                {
+                    return;
+                }
+                if(m_min == nullptr)
+                {
+                    head->left  = tail;
+                    tail->right = head;
+                    m_min       = best;
+                }
+                else
+                {
+                    m_min->left->right = head;
+                    head->left         = m_min->left;
+                    m_min->left        = tail;
+                    tail->right        = m_min;
+                    if(m_comp(best->priority, m_min->priority))
+                    {
+                        m_min = best;
+                    }
+                }
+                m_n += count;
+            };
             try
             {
-                // 1
-                if(m_comp(x->priority, new_priority))
+                for(; first != last; ++first)
                 {
-                    // 2
-                    throw std::out_of_range("new priority is greater than current priority");
+                    Node* x   = std::apply(create, *first);
+                    x->degree = 0;
+                    if(head == nullptr)
+                    {
+                        head = best = x;
+                    }
+                    else
+                    {
+                        tail->right = x;
+                        x->left     = tail;
+                        if(m_comp(x->priority, best->priority))
+                        {
+                            best = x;
+                        }
+                    }
+                    tail = x;
+                    ++count;
+                    onNode(x);
                 }
             }
-            catch(std::out_of_range& e)
-            {
-                e.what();
-                return;
-            }
-            // 3
-            x->priority = std::move(new_priority);
-            // 4, 5
-            if(Node* y = x->p; y != nullptr && m_comp(x->priority, y->priority))
-            {
-                // 6
-                cut(x, y);
-                // 7
-                cascadingCut(y);
-            }
-            // 8
-            if(m_comp(x->priority, m_min->priority))
+            catch(...)
             {
-                // 9
-                m_min = x;
+                splice();
+                throw;
             }
+            splice();
         }
 
-       protected:
         /*
          * extract_min
          * 1. z = H.min
@@ -255,37 +952,25 @@ namespace fiboheap
          */
         Node* extractMin()
         {
-            Node *x, *next;
-            Node** childList;
-
+            if(m_budget != 0 && m_min != nullptr)
+            {
+                tabulate();
+                return extractMinIncremental();
+            }
             // 1
             Node* z = m_min;
             // 2
             if(z != nullptr)
             {
-                // 3
-                x = z->child;
-                if(x != nullptr)
+                // 3, 4 (splice the whole child list in at once, consolidate() resets the parents)
+                if(Node* x = z->child; x != nullptr)
                 {
-                    childList = new Node*[z->degree];
-                    next      = x;
-                    for(int i = 0; i < (int)z->degree; ++i)
-                    {
-                        childList[i] = next;
-                        next         = next->right;
-                    }
-                    for(int i = 0; i < (int)z->degree; ++i)
-                    {
-                        x = childList[i];
-                        // 4
-                        m_min->left->right = x;
-                        x->left            = m_min->left;
-                        m_min->left        = x;
-                        x->right           = m_min;
-                        // 5
-                        x->p = nullptr;
-                    }
-                    delete[] childList;
+                    Node* last     = x->left;
+                    last->right    = z->right;
+                    z->right->left = last;
+                    z->right       = x;
+                    x->left        = z;
+                    z->child       = nullptr;
                 }
                 // 6
                 z->left->right = z->right;
@@ -321,7 +1006,13 @@ namespace fiboheap
             // 1
             y->left->right = y->right;
             y->right->left = y->left;
-            // 2
+            // 2, 3
+            addChild(y, x);
+        }
+
+        //! \brief Makes \p y a child of \p x without touching the list \p y was in
+        void addChild(Node* y, Node* x)
+        {
             if(x->child != nullptr)
             {
                 x->child->left->right = y;
@@ -335,38 +1026,365 @@ namespace fiboheap
             }
             y->p = x;
             ++x->degree;
-            // 3
             y->mark = false;
+            Stats::onLink(x->degree);
+        }
+
+        /**!
+         * \brief Removes \p x from the heap structure without destroying it, in eager mode
+         *
+         * \p x is cut from its parent as if its priority had been decreased to minus
+         * infinity and its children join the root list. When \p x was the minimum,
+         * m_min is left on another root (nullptr if the heap became empty) and the
+         * caller has to restore it, with consolidate() for instance.
+         *
+         * \returns Whether \p x was the minimum
+         */
+        bool detachNode(Node* x)
+        {
+            isolate(x);
+            x->left->right = x->right;
+            x->right->left = x->left;
+            --m_n;
+            if(x != m_min)
+            {
+                return false;
+            }
+            m_min = x->right != x ? x->right : nullptr;
+            return true;
         }
 
-        void deleteNodes(Node* x)
+        /**!
+         * \brief Cuts \p x from its parent and its children from \p x, making it a root of degree 0
+         *
+         * The parent goes through the cascading cut. In eager mode the children are
+         * spliced into the root list next to \p x, in incremental mode \p x and its
+         * children are queued in m_pending.
+         */
+        void isolate(Node* x)
         {
-            if(x == nullptr)
+            if(Node* y = x->p; y != nullptr)
+            {
+                cut(x, y);
+                cascadingCut(y);
+            }
+            else if(m_tabled && m_degree_table[x->degree] == x)
+            {
+                m_degree_table[x->degree] = nullptr;
+                m_pending.push_back(x);
+            }
+            Node* c = x->child;
+            if(c == nullptr)
+            {
+                return;
+            }
+            Node* w = c;
+            do
+            {
+                w->p = nullptr;
+                if(m_tabled)
+                {
+                    m_pending.push_back(w);
+                }
+                w = w->right;
+            } while(w != c);
+            if(!m_tabled)
+            {
+                Node* last     = c->left;
+                last->right    = x->right;
+                x->right->left = last;
+                x->right       = c;
+                c->left        = x;
+            }
+            x->child  = nullptr;
+            x->degree = 0;
+        }
+
+        /**!
+         * \brief Recomputes m_min after the minimum left or got worse
+         *
+         * In eager mode m_min must point into the root list (or be nullptr for an
+         * empty heap) and the root list is consolidated. In incremental mode the
+         * pending roots are linked and the degree table is scanned.
+         */
+        void restoreMin()
+        {
+            if(!m_tabled)
+            {
+                if(m_min != nullptr)
+                {
+                    consolidate();
+                }
+                return;
+            }
+            drain(std::numeric_limits<size_t>::max());
+            scanDegreeTable();
+        }
+
+        //! \brief Sets m_min to the best root of the degree table, in incremental mode
+        void scanDegreeTable()
+        {
+            Node** A = m_degree_table.data();
+            while(m_max_degree > 0 && A[m_max_degree] == nullptr)
+            {
+                --m_max_degree;
+            }
+            m_min = nullptr;
+            for(int d = 0; d <= m_max_degree; ++d)
+            {
+                if(A[d] != nullptr && (m_min == nullptr || m_comp(A[d]->priority, m_min->priority)))
+                {
+                    m_min = A[d];
+                }
+            }
+        }
+
+        //! \brief Calls \p f on every node of the heap, in eager mode
+        template <typename F>
+        void forEachNode(F&& f) const
+        {
+            if(m_min == nullptr)
             {
                 return;
             }
-            Node* cur = x;
-            while(true)
+            std::vector<Node*> lists{m_min};
+            while(!lists.empty())
             {
-                if(cur->left != nullptr && cur->left != x)
+                Node* first = lists.back();
+                lists.pop_back();
+                Node* x = first;
+                do
                 {
-                    Node* tmp = cur;
-                    cur       = cur->left;
-                    if(tmp->child)
+                    // Read the links first so that f may take the node over
+                    Node* next = x->right;
+                    if(x->child != nullptr)
                     {
-                        deleteNodes(tmp->child);
+                        lists.push_back(x->child);
                     }
-                    delete tmp;
+                    f(x);
+                    x = next;
+                } while(x != first);
+            }
+        }
+
+        /**!
+         * \brief Copies the forest of \p other into this empty heap
+         *
+         * The node pool of \p other is copied slab by slab, then the links of
+         * every copy are rebased onto the new slabs, \see FiboNodePool::copyFrom.
+         * If a copy throws, the heap is left empty.
+         *
+         * \returns The map from the nodes of \p other to their copies
+         */
+        typename FiboNodePool<Node>::Rebase copyNodes(const FiboHeap& other)
+        {
+            static_cast<Stats&>(*this) = other;
+            m_comp       = other.m_comp;
+            m_budget     = other.m_budget;
+            m_tabled     = other.m_tabled;
+            m_max_degree = other.m_max_degree;
+            m_pending.reserve(other.m_pending.size());
+            auto rebase = m_pool.copyFrom(other.m_pool, [](Node* y, const auto& rebase) {
+                y->p     = rebase(y->p);
+                y->left  = rebase(y->left);
+                y->right = rebase(y->right);
+                y->child = rebase(y->child);
+            });
+            m_min = rebase(other.m_min);
+            if(m_tabled)
+            {
+                for(int d = 0; d <= m_max_degree; ++d)
+                {
+                    m_degree_table[d] = rebase(other.m_degree_table[d]);
                 }
-                else
+                for(Node* x: other.m_pending)
+                {
+                    m_pending.push_back(rebase(x));
+                }
+            }
+            m_n = other.m_n;
+            return rebase;
+        }
+
+        //! \brief Exchanges the nodes, node pools and settings of this heap and \p other in O(1)
+        void swapNodes(FiboHeap& other) noexcept
+        {
+            std::swap(static_cast<Stats&>(*this), static_cast<Stats&>(other));
+            std::swap(m_n, other.m_n);
+            std::swap(m_min, other.m_min);
+            std::swap(m_comp, other.m_comp);
+            m_pool.swap(other.m_pool);
+            std::swap(m_budget, other.m_budget);
+            std::swap(m_tabled, other.m_tabled);
+            std::swap(m_max_degree, other.m_max_degree);
+            std::swap(m_degree_table, other.m_degree_table);
+            m_pending.swap(other.m_pending);
+            m_cut_parents.swap(other.m_cut_parents);
+        }
+
+        //! \brief Hints that \p x, which may be nullptr, is about to be written
+        static void prefetch(const Node* x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(x, 1);
+#else
+            (void)x;
+#endif
+        }
+
+        //! \returns The size of the payload type, 0 for void
+        static constexpr size_t payloadSize()
+        {
+            if constexpr(std::is_void_v<PayloadType>)
+            {
+                return 0;
+            }
+            else
+            {
+                return sizeof(PayloadType);
+            }
+        }
+
+        //! \brief Calls \p f on every node of the circular list \p x, which may be nullptr
+        template <typename F>
+        static void forEachSibling(const Node* x, F&& f)
+        {
+            if(const Node* first = x; first != nullptr)
+            {
+                do
                 {
-                    if(cur->child)
+                    f(x);
+                    x = x->right;
+                } while(x != first);
+            }
+        }
+
+        //! \brief Loads the file \p path as for load(), then calls \p f on every node in storage order
+        template <typename F>
+        void loadNodes(const std::string& path, F&& f)
+        {
+            static_assert(std::is_trivially_copyable_v<Node>, "load requires trivially copyable priorities, keys and payloads");
+            constexpr size_t kSlotSize = FiboNodePool<Node>::kSlotSize;
+            FiboFile file(path);
+            const FiboFileHeader& header = file.header();
+            if(header.slot_size != kSlotSize || header.priority_size != sizeof(PriorityType)
+               || header.key_size != sizeof(KeyType) || header.payload_size != payloadSize()
+               || header.roots > header.n || (header.n != 0 && header.roots == 0))
+            {
+                throw std::runtime_error("[Error]: " + path + " does not hold nodes of this heap type");
+            }
+            clear();
+            m_tabled     = false;
+            m_max_degree = 0;
+            char* data   = static_cast<char*>(file.data());
+            auto node    = [data](std::uint64_t i) { return reinterpret_cast<Node*>(data + i * kSlotSize); };
+            // Unsigned arithmetic wraps around, so the offset also works downwards
+            std::uintptr_t delta = reinterpret_cast<std::uintptr_t>(data) - static_cast<std::uintptr_t>(header.base);
+            if(delta != 0)
+            {
+                auto offset = [delta](Node*& link) {
+                    if(link != nullptr)
                     {
-                        deleteNodes(cur->child);
+                        link = reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(link) + delta);
                     }
-                    delete cur;
-                    break;
+                };
+                for(std::uint64_t i = 0; i < header.n; ++i)
+                {
+                    Node* x = node(i);
+                    offset(x->p);
+                    offset(x->left);
+                    offset(x->right);
+                    offset(x->child);
+                }
+            }
+            m_pool.adopt(data, header.n, file.keeper());
+            m_n   = header.n;
+            m_min = header.n != 0 ? node(0) : nullptr;
+            if(m_budget != 0)
+            {
+                tabulate();
+            }
+            for(std::uint64_t i = 0; i < header.n; ++i)
+            {
+                f(node(i));
+            }
+        }
+
+        //! \brief Runs the destructor of every node, leaving their storage to the pool
+        void destroyNodes() noexcept
+        {
+            if constexpr(!std::is_trivially_destructible_v<Node>)
+            {
+                destroyNodes([](Node*) {});
+            }
+        }
+
+        //! \brief Calls \p f on every node then runs its destructor, leaving the storage to the pool
+        template <typename F>
+        void destroyNodes(F&& f)
+        {
+            if(!m_tabled)
+            {
+                destroyList(m_min, f);
+                return;
+            }
+            for(int d = 0; d <= m_max_degree; ++d)
+            {
+                destroyTree(m_degree_table[d], f);
+            }
+            for(Node* x: m_pending)
+            {
+                destroyTree(x, f);
+            }
+        }
+
+        //! \brief Empties the heap once its nodes have been destroyed, handing all the node storage back to the pool
+        void reset() noexcept
+        {
+            m_pool.clear();
+            if(m_tabled)
+            {
+                std::fill(m_degree_table.begin(), m_degree_table.begin() + m_max_degree + 1, nullptr);
+                m_pending.clear();
+                m_max_degree = 0;
+            }
+            m_n   = 0;
+            m_min = nullptr;
+        }
+
+        //! \brief Destroys the nodes of the tree rooted at \p x, which may be nullptr, \see destroyNodes
+        template <typename F>
+        void destroyTree(Node* x, F& f)
+        {
+            if(x != nullptr)
+            {
+                // The siblings of a root of the degree table are stale
+                x->left = x->right = x;
+                destroyList(x, f);
+            }
+        }
+
+        //! \brief Destroys the nodes of the circular list \p x and of their subtrees without recursion, \see destroyNodes
+        template <typename F>
+        void destroyList(Node* x, F& f)
+        {
+            if(x == nullptr)
+            {
+                return;
+            }
+            // The list is opened into a chain, every child list is spliced in front of the nodes left
+            x->left->right = nullptr;
+            while(x != nullptr)
+            {
+                Node* next = x->right;
+                if(Node* c = x->child; c != nullptr)
+                {
+                    c->left->right = next;
+                    next           = c;
                 }
+                f(x);
+                x->~Node();
+                x = next;
             }
         }
 
@@ -398,31 +1416,32 @@ namespace fiboheap
          */
         void consolidate()
         {
-            // Max degree <= log base golden ratio of n
-            int max_degree = static_cast<int>(
-                floor(log(static_cast<double>(m_n)) / log(static_cast<double>(1 + sqrt(static_cast<double>(5))) / 2)));
+            // 1, 2, 3 (m_degree_table is left all NIL by the previous call), 4 - 14
+            int max_degree = linkIntoDegreeTable(m_min, 0);
+            // 15 - 23
+            rebuildRootList(max_degree);
+        }
 
-            // 1, 2, 3
-            std::vector<Node*> A(max_degree + 2, nullptr);  // plus two both for indexing to max degree and so A[max_degree+1] == NIL
-            // 4
-            Node* w        = m_min;
-            int root_size  = 0;
-            Node* next     = w;
-            do
-            {
-                ++root_size;
-                next = next->right;
-            } while(next != w);
-            std::vector<Node*> root_list(root_size);
-            for(int i = 0; i < root_size; ++i)
-            {
-                root_list[i] = next;
-                next        = next->right;
-            }
-            for(int i = 0; i < root_size; ++i)
+        /**!
+         * \brief Links the circular list starting at \p w into m_degree_table (consolidate, 4 - 14)
+         *
+         * \param max_degree The highest occupied degree of the table so far
+         *
+         * \returns The highest occupied degree of the table
+         */
+        int linkIntoDegreeTable(Node* w, int max_degree)
+        {
+            Node** A = m_degree_table.data();
+            // 4 (the list is unthreaded into a chain, the root list is rebuilt from A afterwards)
+            w->left->right     = nullptr;
+            std::uint64_t roots = 0;
+            while(w != nullptr)
             {
                 // 5
-                Node* x = w = root_list[i];
+                Node* x = w;
+                w       = w->right;
+                ++roots;
+                x->p    = nullptr;
                 // 6
                 int degree = x->degree;
                 // 7
@@ -437,47 +1456,161 @@ namespace fiboheap
                         std::swap(x, y);
                     }
                     // 11
-                    fibHeapLink(y, x);
+                    addChild(y, x);
                     // 12
                     A[degree] = nullptr;
                     // 13
-                    ++ degree;
+                    ++degree;
                 }
                 // 14
-                A[degree] = x;
+                A[degree]  = x;
+                max_degree = std::max(max_degree, degree);
             }
+            Stats::onConsolidate(roots);
+            return max_degree;
+        }
+
+        //! \brief Threads the nodes of m_degree_table into the root list and empties the table (consolidate, 15 - 23)
+        void rebuildRootList(int max_degree)
+        {
+            Node** A = m_degree_table.data();
             // 15
             m_min = nullptr;
             // 16
-            for(int i = 0; i < max_degree + 2; ++ i)
+            for(int i = 0; i <= max_degree; ++i)
             {
                 // 17
-                if(A[i] != nullptr)
+                if(Node* x = A[i]; x != nullptr)
                 {
+                    A[i] = nullptr;
                     // 18
                     if(m_min == nullptr)
                     {
                         // 19, 20
-                        m_min = A[i]->left = A[i]->right = A[i];
+                        m_min = x->left = x->right = x;
                     }
                     else
                     {
                         // 21
-                        m_min->left->right = A[i];
-                        A[i]->left         = m_min->left;
-                        m_min->left        = A[i];
-                        A[i]->right        = m_min;
+                        m_min->left->right = x;
+                        x->left            = m_min->left;
+                        m_min->left        = x;
+                        x->right           = m_min;
                         // 22
-                        if(m_comp(A[i]->priority, m_min->priority))
+                        if(m_comp(x->priority, m_min->priority))
                         {
                             // 23
-                            m_min = A[i];
+                            m_min = x;
                         }
                     }
                 }
             }
         }
 
+        /**!
+         * \brief Extracts the minimum in incremental mode
+         *
+         * The pending roots are linked into the degree table, the minimum leaves its
+         * slot and its children are linked in, and the new minimum is the best of
+         * the at most D(n) + 1 roots of the table.
+         */
+        Node* extractMinIncremental()
+        {
+            drain(std::numeric_limits<size_t>::max());
+            Node** A = m_degree_table.data();
+            Node* z  = m_min;
+            A[z->degree] = nullptr;
+            if(Node* c = z->child; c != nullptr)
+            {
+                c->left->right = nullptr;
+                while(c != nullptr)
+                {
+                    Node* next = c->right;
+                    linkRoot(c);
+                    c = next;
+                }
+                z->child = nullptr;
+            }
+            scanDegreeTable();
+            --m_n;
+            return z;
+        }
+
+        //! \brief Links the root \p x into the degree table (consolidate, 5 - 14), keeping m_min a root
+        void linkRoot(Node* x)
+        {
+            Node** A = m_degree_table.data();
+            x->p     = nullptr;
+            int d    = x->degree;
+            while(A[d] != nullptr)
+            {
+                Node* y = A[d];
+                // On ties the minimum stays on top, so that top() and pop() keep agreeing on the node
+                if(m_comp(y->priority, x->priority) || (y == m_min && !m_comp(x->priority, y->priority)))
+                {
+                    std::swap(x, y);
+                }
+                addChild(y, x);
+                A[d] = nullptr;
+                ++d;
+            }
+            A[d]         = x;
+            m_max_degree = std::max(m_max_degree, d);
+            // x is at least as good as every node it took, the minimum included if it was linked under x
+            if(m_min == nullptr || m_min->p != nullptr || m_comp(x->priority, m_min->priority))
+            {
+                m_min = x;
+            }
+        }
+
+        //! \brief Links up to \p budget pending roots into the degree table
+        void drain(size_t budget)
+        {
+            for(; budget != 0 && !m_pending.empty(); --budget)
+            {
+                Node* x = m_pending.back();
+                m_pending.pop_back();
+                linkRoot(x);
+            }
+        }
+
+        //! \brief Moves the roots from the root list to the degree table, for incremental mode
+        void tabulate()
+        {
+            if(m_tabled)
+            {
+                return;
+            }
+            m_tabled     = true;
+            m_max_degree = 0;
+            if(Node* w = m_min; w != nullptr)
+            {
+                w->left->right      = nullptr;
+                std::uint64_t roots = 0;
+                while(w != nullptr)
+                {
+                    Node* next = w->right;
+                    linkRoot(w);
+                    w = next;
+                    ++roots;
+                }
+                Stats::onConsolidate(roots);
+            }
+        }
+
+        //! \brief Moves the roots from the degree table back to the root list, for eager mode
+        void settle()
+        {
+            if(!m_tabled)
+            {
+                return;
+            }
+            drain(std::numeric_limits<size_t>::max());
+            rebuildRootList(m_max_degree);
+            m_tabled     = false;
+            m_max_degree = 0;
+        }
+
         /*
          * cut(x,y)
          * 1. remove x from the child list of y, decrementing y.degree
@@ -501,16 +1634,30 @@ namespace fiboheap
                     y->child = x->right;
                 }
             }
+            if(m_tabled && y->p == nullptr && m_degree_table[y->degree] == y)
+            {
+                // y leaves its slot of the degree table and is queued again with its new degree
+                m_degree_table[y->degree] = nullptr;
+                m_pending.push_back(y);
+            }
             -- y->degree;
             // 2
-            m_min->right->left = x;
-            x->right           = m_min->right;
-            m_min->right       = x;
-            x->left            = m_min;
+            if(m_tabled)
+            {
+                m_pending.push_back(x);
+            }
+            else
+            {
+                m_min->right->left = x;
+                x->right           = m_min->right;
+                m_min->right       = x;
+                x->left            = m_min;
+            }
             // 3
             x->p = nullptr;
             // 4
             x->mark = false;
+            Stats::onCut();
         }
 
         /*
@@ -524,27 +1671,39 @@ namespace fiboheap
          */
         void cascadingCut(Node* y)
         {
-            // 1, 2
-            if(Node* z = y->p; z != nullptr)
+            std::uint64_t depth = 0;
+            // 1, 2 (the recursion of 6 is unrolled into the loop)
+            for(Node* z = y->p; z != nullptr; y = z, z = y->p)
             {
                 // 3
                 if(!y->mark)
                 {
                     // 4
                     y->mark = true;
+                    break;
                 }
-                else
-                {
-                    // 5
-                    cut(y, z);
-                    // 6
-                    cascadingCut(z);
-                }
+                // 5
+                cut(y, z);
+                ++depth;
             }
+            Stats::onCascade(depth);
         }
 
         size_t m_n;
         Node* m_min;
         Comparator m_comp;
+        FiboNodePool<Node> m_pool;
+        //! Roots linked per operation in incremental mode, 0 in eager mode
+        size_t m_budget;
+        //! Whether the roots are held by m_degree_table and m_pending rather than by the root list
+        bool m_tabled;
+        //! Highest occupied degree of m_degree_table while m_tabled
+        int m_max_degree;
+        //! Table for consolidate(), indexed by degree; all NIL between calls in eager mode, holds the roots in incremental mode
+        std::array<Node*, kMaxDegree> m_degree_table{};
+        //! Roots waiting to be linked into m_degree_table in incremental mode
+        std::vector<Node*> m_pending;
+        //! Scratch list of the parents cut from by decreasePriorityBatch()
+        std::vector<Node*> m_cut_parents;
     };
 }  // namespace fiboheap
\ No newline at end of file
@@ -19,42 +19,63 @@
 #pragma once
 
 // Global
-#include <memory>
 #include <utility>
 
 namespace fiboheap
 {
+    /**!
+     * \brief Payload stored by value inside a FiboNode
+     *
+     * \tparam PayloadType The data to store with the node
+     */
+    template <typename PayloadType>
+    class FiboPayload
+    {
+       public:
+        template <typename... Args>
+        explicit FiboPayload(Args&&... args)
+            : payload(std::forward<Args>(args)...)
+        {}
+
+        PayloadType payload;
+    };
+
+    //! \brief A node without payload does not carry a payload field at all
+    template <>
+    class FiboPayload<void>
+    {};
+
     /**!
      * \brief Node for a FiboHeap
      *
      * \tparam PriorityType The type used to represent the priority of this node
      * \tparam KeyType The type used for the identifier for the payload in this node
-     * \tparam PayloadType The data to store with this node
+     * \tparam PayloadType The data to store with this node, void for none
      */
     template <typename PriorityType, typename KeyType, typename PayloadType>
-    class FiboNode
+    class FiboNode : public FiboPayload<PayloadType>
     {
        public:
-        FiboNode(PriorityType priority, KeyType k, std::shared_ptr<PayloadType> payload= nullptr)
-            : priority(std::move(priority))
+        template <typename... Args>
+        FiboNode(PriorityType priority, KeyType k, Args&&... args)
+            : FiboPayload<PayloadType>(std::forward<Args>(args)...)
+            , priority(std::move(priority))
             , key(std::move(k))
-            , payload(payload)
-            , mark(false)
             , p(nullptr)
             , left(nullptr)
             , right(nullptr)
             , child(nullptr)
             , degree(-1)
+            , mark(false)
         {}
 
         PriorityType priority;
         KeyType key;
-        std::shared_ptr<PayloadType> payload;
-        bool mark;
         FiboNode *p;
         FiboNode *left;
         FiboNode *right;
         FiboNode *child;
         int degree;
+        bool mark;
     };
 }  // namespace fiboheap
@@ -0,0 +1,453 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace fiboheap
+{
+    /**!
+     * \brief Slab allocator for heap nodes
+     *
+     * Nodes are carved out of geometrically growing slabs and recycled through
+     * an intrusive free list, so a heap in steady state (as many pushes as pops)
+     * does not touch the global allocator. Node addresses are stable for the
+     * lifetime of the pool.
+     *
+     * \tparam Node The node type being allocated
+     */
+    template <typename Node>
+    class FiboNodePool
+    {
+        //! Raw storage for a single node, reused as a free list link when unused
+        union Slot
+        {
+            Slot* next;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        struct Slab
+        {
+            Slot* data;
+            size_t size;
+            //! Number of slots nodes are carved from, less than size when merge() split the tail off
+            size_t limit;
+            //! Whether the pool allocated data, false for the unused tail of a merged slab
+            bool owner;
+        };
+
+       public:
+        //! Number of nodes in the first slab allocated by the pool
+        static constexpr size_t kMinSlabSize = 64;
+
+        //! Size of the storage of a node, the stride of the arrays given to adopt()
+        static constexpr size_t kSlotSize = sizeof(Slot);
+
+        //! \brief Default Constructor
+        FiboNodePool()
+            : m_free(nullptr)
+            , m_free_tail(nullptr)
+            , m_cur(nullptr)
+            , m_end(nullptr)
+            , m_next_slab(0)
+            , m_capacity(0)
+            , m_live(0)
+        {}
+
+        FiboNodePool(const FiboNodePool&) = delete;
+        FiboNodePool& operator=(const FiboNodePool&) = delete;
+
+        //! \brief Destructor, nodes must have been destroyed beforehand
+        ~FiboNodePool() noexcept
+        {
+            deallocate();
+        }
+
+        //! \brief Maps the nodes of a pool to their copies in a pool filled by copyFrom()
+        class Rebase
+        {
+           public:
+            //! \returns The copy of \p x, nullptr for nullptr
+            Node* operator()(const Node* x) const noexcept
+            {
+                if(x == nullptr)
+                {
+                    return nullptr;
+                }
+                const Slot* s  = reinterpret_cast<const Slot*>(x);
+                const Range& r = find(s);
+                return reinterpret_cast<Node*>(r.dst + (s - r.src));
+            }
+
+           private:
+            friend class FiboNodePool;
+
+            //! A slab of the source pool, the number of slots nodes were carved from and its copy
+            struct Range
+            {
+                const Slot* src;
+                size_t n;
+                Slot* dst;
+                //! Index of the first slot among all the ranges
+                size_t first;
+            };
+
+            //! \returns The range holding \p s
+            const Range& find(const Slot* s) const noexcept
+            {
+                // Slabs grow geometrically and the ranges are sorted by decreasing size,
+                // so most slots are found within the first couple of ranges
+                auto address = reinterpret_cast<std::uintptr_t>(s);
+                for(const Range& r: m_ranges)
+                {
+                    if(address - reinterpret_cast<std::uintptr_t>(r.src) < r.n * sizeof(Slot))
+                    {
+                        return r;
+                    }
+                }
+                return m_ranges.back();
+            }
+
+            std::vector<Range> m_ranges;
+        };
+
+        //! \returns The number of nodes the pool can hold without allocating
+        size_t capacity() const noexcept
+        {
+            return m_capacity;
+        }
+
+        //! \returns The number of nodes currently handed out
+        size_t size() const noexcept
+        {
+            return m_live;
+        }
+
+        //! \brief Ensures that \p n nodes can be live without further allocation
+        void reserve(size_t n)
+        {
+            if(n > m_capacity)
+            {
+                addSlab(n - m_capacity);
+            }
+        }
+
+        //! \brief Constructs a node from \p args in pooled storage
+        template <typename... Args>
+        Node* create(Args&&... args)
+        {
+            Slot* slot = acquire();
+            try
+            {
+                Node* x = ::new(static_cast<void*>(slot->storage)) Node(std::forward<Args>(args)...);
+                ++m_live;
+                return x;
+            }
+            catch(...)
+            {
+                release(slot);
+                throw;
+            }
+        }
+
+        //! \brief Destroys \p x and returns its storage to the free list
+        void destroy(Node* x) noexcept
+        {
+            x->~Node();
+            release(reinterpret_cast<Slot*>(x));
+            --m_live;
+        }
+
+        /**!
+         * \brief Takes over the storage of \p other, including the nodes it handed out
+         *
+         * Slabs change owner without being copied and the free lists are spliced, so
+         * the cost is linear in the number of slabs of \p other, which is logarithmic
+         * in its capacity. The unused tail of the slab \p other was carving from is
+         * kept as a fresh range to carve from later.
+         */
+        void merge(FiboNodePool&& other)
+        {
+            if(&other == this)
+            {
+                return;
+            }
+            m_slabs.reserve(m_slabs.size() + other.m_slabs.size() + 1);
+            // Slabs already carved from go before our fresh ones, fresh slabs at the end
+            m_slabs.insert(m_slabs.begin() + m_next_slab,
+                           other.m_slabs.begin(),
+                           other.m_slabs.begin() + other.m_next_slab);
+            m_slabs.insert(m_slabs.end(), other.m_slabs.begin() + other.m_next_slab, other.m_slabs.end());
+            m_next_slab += other.m_next_slab;
+            if(other.m_cur != other.m_end)
+            {
+                // The tail of the slab other was carving from becomes a fresh slab of its own
+                for(auto it = m_slabs.begin() + (m_next_slab - other.m_next_slab); it != m_slabs.begin() + m_next_slab; ++it)
+                {
+                    if(other.isCarving(*it))
+                    {
+                        it->limit = static_cast<size_t>(other.m_cur - it->data);
+                    }
+                }
+                size_t n = static_cast<size_t>(other.m_end - other.m_cur);
+                m_slabs.push_back({other.m_cur, n, n, false});
+            }
+            if(other.m_free != nullptr)
+            {
+                other.m_free_tail->next = m_free;
+                if(m_free == nullptr)
+                {
+                    m_free_tail = other.m_free_tail;
+                }
+                m_free = other.m_free;
+            }
+            m_capacity += other.m_capacity;
+            m_live += other.m_live;
+            m_keepers.insert(m_keepers.end(), other.m_keepers.begin(), other.m_keepers.end());
+            other.m_keepers.clear();
+            other.m_slabs.clear();
+            other.m_free = other.m_free_tail = other.m_cur = other.m_end = nullptr;
+            other.m_next_slab = other.m_capacity = other.m_live = 0;
+        }
+
+        /**!
+         * \brief Takes back every node handed out, which must have been destroyed
+         *
+         * The slabs are kept and carved from the start again, the free list is
+         * dropped rather than walked.
+         */
+        void clear() noexcept
+        {
+            m_free = m_free_tail = m_cur = m_end = nullptr;
+            m_next_slab = m_live = 0;
+        }
+
+        //! \brief Exchanges the slabs and the nodes handed out of this pool and \p other, which keep their addresses
+        void swap(FiboNodePool& other) noexcept
+        {
+            std::swap(m_free, other.m_free);
+            std::swap(m_free_tail, other.m_free_tail);
+            std::swap(m_cur, other.m_cur);
+            std::swap(m_end, other.m_end);
+            std::swap(m_next_slab, other.m_next_slab);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_live, other.m_live);
+            m_slabs.swap(other.m_slabs);
+            m_keepers.swap(other.m_keepers);
+        }
+
+        /**!
+         * \brief Makes this pool, which must have no node handed out, hand out the \p n nodes at \p data
+         *
+         * The current slabs of the pool are freed and the nodes, constructed by
+         * the caller, become its only slab without being copied. \p keeper is
+         * released with the pool. The slab can be carved again after clear().
+         *
+         * \param data An array of \p n storage slots of kSlotSize bytes, aligned for the nodes
+         * \param keeper Owner of \p data, for instance a memory mapping
+         */
+        void adopt(void* data, size_t n, std::shared_ptr<void> keeper)
+        {
+            clearSlabs();
+            if(n == 0)
+            {
+                return;
+            }
+            Slot* slots = static_cast<Slot*>(data);
+            m_slabs.push_back({slots, n, n, false});
+            m_keepers.push_back(std::move(keeper));
+            m_cur = m_end = slots + n;
+            m_next_slab   = 1;
+            m_capacity    = n;
+            m_live        = n;
+        }
+
+        /**!
+         * \brief Makes this pool, which must have no node handed out, a copy of \p other
+         *
+         * Every slab of \p other that nodes were carved from is mirrored by a
+         * slab, and every node is copy constructed at the same position in its
+         * copy, walking \p other in storage order: memory is read sequentially,
+         * and the copy of a node is found from its address by the returned
+         * Rebase. The free list is rebuilt from the same slots. The current slabs
+         * of this pool are freed. If a copy throws, the copies made so far are
+         * destroyed and the pool is left empty.
+         *
+         * \param f Called with every copy and the Rebase, to fix up the pointers the copy holds
+         */
+        template <typename F>
+        Rebase copyFrom(const FiboNodePool& other, F&& f)
+        {
+            clearSlabs();
+            Rebase rebase;
+            auto& ranges = rebase.m_ranges;
+            // Whether each slot of the ranges is on the free list of other
+            std::vector<bool> free;
+            try
+            {
+                ranges.reserve(other.m_next_slab);
+                m_slabs.reserve(other.m_next_slab);
+                size_t slots = 0;
+                for(size_t i = 0; i < other.m_next_slab; ++i)
+                {
+                    const Slab& slab = other.m_slabs[i];
+                    addSlab(slab.limit);
+                    Slot* dst = m_slabs.back().data;
+                    size_t n  = slab.limit;
+                    if(other.isCarving(slab))
+                    {
+                        n     = static_cast<size_t>(other.m_cur - slab.data);
+                        m_cur = dst + n;
+                        m_end = dst + slab.limit;
+                    }
+                    ranges.push_back({slab.data, n, dst, slots});
+                    slots += n;
+                }
+                m_next_slab = other.m_next_slab;
+                std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) { return a.n > b.n; });
+                free.resize(slots, false);
+                for(const Slot* s = other.m_free; s != nullptr; s = s->next)
+                {
+                    const auto& r               = rebase.find(s);
+                    free[r.first + (s - r.src)] = true;
+                }
+                for(const auto& r: ranges)
+                {
+                    for(size_t k = 0; k < r.n; ++k)
+                    {
+                        if(free[r.first + k])
+                        {
+                            release(r.dst + k);
+                            continue;
+                        }
+                        const Node& x = *reinterpret_cast<const Node*>(r.src[k].storage);
+                        Node* y       = ::new(static_cast<void*>(r.dst[k].storage)) Node(x);
+                        ++m_live;
+                        f(y, rebase);
+                    }
+                }
+            }
+            catch(...)
+            {
+                // The copies were made in range order, the first m_live live slots hold one
+                for(const auto& r: ranges)
+                {
+                    for(size_t k = 0; k < r.n && m_live != 0; ++k)
+                    {
+                        if(!free[r.first + k])
+                        {
+                            reinterpret_cast<Node*>(r.dst[k].storage)->~Node();
+                            --m_live;
+                        }
+                    }
+                }
+                clearSlabs();
+                throw;
+            }
+            return rebase;
+        }
+
+       private:
+        //! \returns Whether \p slab is the one nodes are being carved from
+        bool isCarving(const Slab& slab) const noexcept
+        {
+            // Carving from a slab starts by handing out its first slot, m_cur is past it
+            return m_cur != nullptr && std::less<const Slot*>()(slab.data, m_cur)
+                   && !std::less<const Slot*>()(slab.data + slab.limit, m_cur);
+        }
+
+        //! \brief Frees the slabs the pool allocated
+        void deallocate() noexcept
+        {
+            for(Slab& slab: m_slabs)
+            {
+                if(slab.owner)
+                {
+                    std::allocator<Slot>().deallocate(slab.data, slab.size);
+                }
+            }
+        }
+
+        //! \brief Frees the slabs and leaves the pool empty
+        void clearSlabs() noexcept
+        {
+            deallocate();
+            m_slabs.clear();
+            m_keepers.clear();
+            m_free = m_free_tail = m_cur = m_end = nullptr;
+            m_next_slab = m_capacity = m_live = 0;
+        }
+
+        Slot* acquire()
+        {
+            if(m_free != nullptr)
+            {
+                Slot* slot = m_free;
+                m_free     = slot->next;
+                return slot;
+            }
+            if(m_cur == m_end)
+            {
+                if(m_next_slab == m_slabs.size())
+                {
+                    addSlab(std::max(kMinSlabSize, m_capacity));
+                }
+                m_cur = m_slabs[m_next_slab].data;
+                m_end = m_cur + m_slabs[m_next_slab].limit;
+                ++m_next_slab;
+            }
+            return m_cur++;
+        }
+
+        void release(Slot* slot) noexcept
+        {
+            if(m_free == nullptr)
+            {
+                m_free_tail = slot;
+            }
+            slot->next = m_free;
+            m_free     = slot;
+        }
+
+        void addSlab(size_t n)
+        {
+            m_slabs.reserve(m_slabs.size() + 1);
+            m_slabs.push_back({std::allocator<Slot>().allocate(n), n, n, true});
+            m_capacity += n;
+        }
+
+        Slot* m_free;
+        //! Last slot of the free list, meaningful when m_free is not null
+        Slot* m_free_tail;
+        Slot* m_cur;
+        Slot* m_end;
+        size_t m_next_slab;
+        size_t m_capacity;
+        size_t m_live;
+        std::vector<Slab> m_slabs;
+        //! Owners of the storage of the slabs given to adopt()
+        std::vector<std::shared_ptr<void>> m_keepers;
+    };
+}  // namespace fiboheap
@@ -20,12 +20,15 @@
 
 // Global
 #include <sstream>
-
-// External
-#include <robin_hood.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // Local
 #include "fiboheap/fibo_heap.hpp"
+#include "fiboheap/fibo_store.hpp"
 
 namespace fiboheap
 {
@@ -35,36 +38,109 @@ namespace fiboheap
      *
      * \tparam KeyType The type being stored
      * \tparam PayloadType The type of the payload to associate with the key
-     * \tparam Comp A comparison of the value of keys
+     * \tparam Comp A comparison of priorities
+     * \tparam Store The fast store mapping keys to nodes (HashNodeStore or DenseNodeStore)
+     * \tparam Stats The statistics policy, FiboStats also counts the probes of the fast store
      */
-    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comp = std::less<KeyType>>
-    class FiboQueue : public FiboHeap<PriorityType, KeyType, PayloadType, Comp>
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              typename Comp = std::less<PriorityType>,
+              template <typename, typename> class Store = HashNodeStore,
+              typename Stats = NoStats>
+    class FiboQueue : public FiboHeap<PriorityType, KeyType, PayloadType, Comp, Stats>
     {
-        using Heap = FiboHeap<PriorityType, KeyType, PayloadType, Comp>;
+        using Heap = FiboHeap<PriorityType, KeyType, PayloadType, Comp, Stats>;
        public:
         using Node = typename Heap::Node;
-        using Map = robin_hood::unordered_map<KeyType, Node*>;
-        using KeyNodeIter = typename Map::iterator;
+        using NodeStore = Store<KeyType, Node>;
+        using value_type = typename Heap::value_type;
 
         //! \brief Default Constructor
         FiboQueue() = default;
 
-        //! \returns The iterator associated with the \p key
-        KeyNodeIter find(KeyType key)
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        FiboQueue(InputIt first, InputIt last)
+        {
+            push_range(first, last);
+        }
+
+        /**!
+         * \brief Copy Constructor
+         *
+         * The fast store is copied as a whole and its nodes rebased onto the
+         * copies. \see FiboHeap::FiboHeap(const FiboHeap&)
+         */
+        FiboQueue(const FiboQueue& other)
+            : Heap()
+            , m_fstore()
+        {
+            copyFrom(other);
+        }
+
+        //! \brief Copy Assignment, \see FiboQueue(const FiboQueue&)
+        FiboQueue& operator=(const FiboQueue& other)
+        {
+            if(&other != this)
+            {
+                clear();
+                copyFrom(other);
+            }
+            return *this;
+        }
+
+        /**!
+         * \brief Move Constructor
+         *
+         * Takes the nodes and the fast store of \p other without copying them,
+         * \see FiboHeap::FiboHeap(FiboHeap&&). \p other is left empty.
+         */
+        FiboQueue(FiboQueue&& other) noexcept
+            : Heap(std::move(other))
+            , m_fstore()
         {
-            return m_fstore.find(key);
+            std::swap(m_fstore, other.m_fstore);
         }
 
-        //! \returns The FiboNode associated with the \p key
-        Node* findNode(KeyType key)
+        //! \brief Move Assignment, the nodes of this queue are destroyed, \see FiboQueue(FiboQueue&&)
+        FiboQueue& operator=(FiboQueue&& other) noexcept
         {
-            return find(key)->second;
+            if(&other != this)
+            {
+                clear();
+                Heap::swapNodes(other);
+                std::swap(m_fstore, other.m_fstore);
+            }
+            return *this;
         }
 
-        //! \returns Whether the \p is in the queue
-        bool contains(KeyType key)
+        //! \returns A deep copy of the queue, for instance to fork a search, \see FiboQueue(const FiboQueue&)
+        FiboQueue clone() const
         {
-            return m_fstore.find(key) != m_fstore.end();
+            return FiboQueue(*this);
+        }
+
+        //! \returns The FiboNode associated with the \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            return probe().find(key);
+        }
+
+        //! \returns The FiboNode associated with the \p key, nullptr if absent
+        Node* findNode(const KeyType& key) const
+        {
+            return find(key);
+        }
+
+        //! \returns Whether the \p key is in the queue
+        bool contains(const KeyType& key) const
+        {
+            return probe().find(key) != nullptr;
         }
 
         //! \brief Removes the top element from the queue
@@ -74,38 +150,363 @@ namespace fiboheap
             {
                 return;
             }
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Pop);
             Node* x = Heap ::extractMin();
-            auto iter = m_fstore.find(x->key);
-            if(iter != m_fstore.end())
-            {
-                m_fstore.erase(iter);
-            }
-            else
+            if(!probe().erase(x->key))
             {
                 std::stringstream ss;
                 ss << "[Error]: key " << x->key
                    << " cannot be found in FiboQueue fast store";
                 throw std::runtime_error(ss.str());
             }
-            delete x;
+            Heap::m_pool.destroy(x);
+        }
+
+        //! \brief Removes \p x from the queue and from the fast store, \see FiboHeap::erase
+        void erase(Node* x)
+        {
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Erase);
+            probe().erase(x->key);
+            Heap::erase(x);
+        }
+
+        //! \brief Removes \p key from the queue, probing the fast store once, \returns false if it was absent
+        bool erase(const KeyType& key)
+        {
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Erase);
+            Node* x = probe().extract(key);
+            if(x == nullptr)
+            {
+                return false;
+            }
+            Heap::erase(x);
+            return true;
+        }
+
+        //! \see erase
+        void removeNode(Node* x)
+        {
+            erase(x);
+        }
+
+        /**!
+         * \brief Pushes \p key if it is absent, otherwise decreases its priority if \p priority is better
+         *
+         * The fast store is probed once, except KeyOnceNodeStore, which probes its
+         * set a second time to insert an absent key. When the priority improves,
+         * the payload (if any is given) replaces the stored one.
+         */
+        template <typename... Payload>
+        UpdateResult upsert(KeyType key, PriorityType priority, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "upsert takes at most one payload");
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Upsert);
+            auto [x, inserted] = probe().findOrInsert(key, [&]() {
+                return Heap::emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+            });
+            if(inserted)
+            {
+                return UpdateResult::Inserted;
+            }
+            if(!Heap::m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            Heap::decreasePriority(x, std::move(priority));
+            if constexpr(sizeof...(Payload) == 1)
+            {
+                ((x->payload = std::forward<Payload>(payload)), ...);
+            }
+            return UpdateResult::Improved;
+        }
+
+        //! \brief Decreases the priority of \p key if it is present and \p priority is better, probing the fast store once
+        UpdateResult tryDecrease(const KeyType& key, PriorityType priority)
+        {
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Decrease);
+            Node* x = probe().find(key);
+            if(x == nullptr)
+            {
+                return UpdateResult::Absent;
+            }
+            if(!Heap::m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            Heap::decreasePriority(x, std::move(priority));
+            return UpdateResult::Improved;
+        }
+
+        /**!
+         * \brief Decrease the priority of several elements at once
+         *
+         * With (key, priority) pairs, all the keys are first resolved in the fast
+         * store into a scratch list, without touching the nodes, then the nodes
+         * are updated in a single FiboHeap::decreasePriorityBatch, which
+         * prefetches them ahead of the cuts.
+         *
+         * \param first, last A range of pairs (key, new priority), or (Node*, new priority)
+         * \param rejected Receives the keys (or nodes) absent from the queue or whose
+         * new priority was greater than the current one
+         *
+         * \returns The number of elements whose priority was decreased
+         */
+        template <typename InputIt, typename RejectIt>
+        size_t decreasePriorityBatch(InputIt first, InputIt last, RejectIt rejected)
+        {
+            using First = std::decay_t<decltype(std::get<0>(*first))>;
+            if constexpr(std::is_convertible_v<First, Node*> && !std::is_convertible_v<First, KeyType>)
+            {
+                return Heap::decreasePriorityBatch(first, last, rejected);
+            }
+            else
+            {
+                for(; first != last; ++first)
+                {
+                    Node* x = probe().find(std::get<0>(*first));
+                    if(x == nullptr)
+                    {
+                        *rejected++ = std::get<0>(*first);
+                        continue;
+                    }
+                    m_batch.emplace_back(x, std::get<1>(*first));
+                }
+                struct RejectKey
+                {
+                    RejectKey& operator*()
+                    {
+                        return *this;
+                    }
+
+                    RejectKey& operator++(int)
+                    {
+                        return *this;
+                    }
+
+                    RejectKey& operator=(Node* x)
+                    {
+                        *out++ = x->key;
+                        return *this;
+                    }
+
+                    RejectIt& out;
+                };
+                size_t decreased = Heap::decreasePriorityBatch(m_batch.begin(), m_batch.end(), RejectKey{rejected});
+                m_batch.clear();
+                return decreased;
+            }
+        }
+
+        //! \see decreasePriorityBatch, rejected elements are ignored
+        template <typename InputIt>
+        size_t decreasePriorityBatch(InputIt first, InputIt last)
+        {
+            return decreasePriorityBatch(first, last, DiscardIterator());
+        }
+
+        /**!
+         * \brief Removes the \p k top elements from the queue with a single consolidation
+         *
+         * \see FiboHeap::popN
+         */
+        template <typename OutputIt>
+        OutputIt popN(size_t k, OutputIt out)
+        {
+            Heap::extractMinN(k, [&](Node* x) {
+                probe().erase(x->key);
+                *out++ = Heap::release(x);
+            });
+            return out;
         }
 
         //! \brief Pushes \p key onto the queue
-        Node* push(PriorityType priority, KeyType key, std::shared_ptr<PayloadType> payload = nullptr)
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Pushes \p key onto the queue, constructing its payload in place from \p args
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
         {
-            Node* x = Heap::push(std::move(priority), std::move(key), payload);
-            m_fstore.insert({key, x});
+            [[maybe_unused]] auto timer = Heap::timer(StatsOp::Push);
+            Node* x = Heap::emplace(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            probe().insert(x->key, x);
             return x;
         }
 
-        //! \brief Clears all the elements from the queue
+        /**!
+         * \brief Pushes a range of elements onto the queue in a single pass
+         *
+         * \param first, last The range of tuple-like elements (priority, key[, payload])
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                m_fstore.reserve(Heap::size() + static_cast<size_t>(std::distance(first, last)));
+            }
+            Heap::insertRange(first, last, [this](Node* x) { probe().insert(x->key, x); });
+        }
+
+        /**!
+         * \brief Moves all the elements of \p other into this queue, leaving it empty
+         *
+         * The fast store is sized for both queues up front, then the keys of
+         * \p other are moved into it one by one. The losers of duplicate keys are
+         * detached from their heap without consolidating it, a heap whose minimum
+         * was removed is consolidated once, and the heaps are melded in O(1).
+         *
+         * \param policy Which element is kept when a key is in both queues
+         */
+        void meld(FiboQueue&& other, DuplicatePolicy policy = DuplicatePolicy::KeepBetter)
+        {
+            if(&other == this)
+            {
+                return;
+            }
+            Heap::settle();
+            other.Heap::settle();
+            m_fstore.reserve(Heap::size() + other.size());
+            std::vector<Node*> nodes;
+            nodes.reserve(other.size());
+            other.forEachNode([&nodes](Node* x) { nodes.push_back(x); });
+            bool stale       = false;
+            bool other_stale = false;
+            for(Node* x: nodes)
+            {
+                auto [y, inserted] = probe().findOrInsert(x->key, [x]() { return x; });
+                if(inserted)
+                {
+                    continue;
+                }
+                if(policy == DuplicatePolicy::KeepOther
+                   || (policy == DuplicatePolicy::KeepBetter && Heap::m_comp(x->priority, y->priority)))
+                {
+                    probe().erase(y->key);
+                    probe().insert(x->key, x);
+                    stale |= Heap::detachNode(y);
+                    Heap::m_pool.destroy(y);
+                }
+                else
+                {
+                    other_stale |= other.Heap::detachNode(x);
+                    other.Heap::m_pool.destroy(x);
+                }
+            }
+            if(stale && Heap::m_min != nullptr)
+            {
+                Heap::consolidate();
+            }
+            if(other_stale && other.Heap::m_min != nullptr)
+            {
+                other.Heap::consolidate();
+            }
+            other.m_fstore.clear();
+            Heap::meld(std::move(other));
+        }
+
+        //! \brief Pre-allocates the node pool and the fast store for \p n elements
+        void reserve(size_t n)
+        {
+            Heap::reserve(n);
+            m_fstore.reserve(n);
+        }
+
+        /**!
+         * \brief Clears all the elements from the queue, keeping the node storage and the buckets of the fast store
+         *
+         * When few elements are left compared to the capacity, which bounds the
+         * number of keys the store has held, their keys are erased one by one
+         * rather than clearing the whole store, so that resetting a reused queue
+         * does not cost as much as the largest content it ever had.
+         *
+         * \see FiboHeap::clear
+         */
         void clear()
         {
-            Heap::clear();
-            m_fstore.clear();
+            if(Heap::size() * 16 < Heap::capacity())
+            {
+                Heap::destroyNodes([this](Node* x) { probe().erase(x->key); });
+            }
+            else
+            {
+                m_fstore.clear();
+                Heap::destroyNodes();
+            }
+            Heap::reset();
+        }
+
+        /**!
+         * \brief Replaces the content of the queue by that of the file \p path written by save()
+         *
+         * The nodes are adopted as by FiboHeap::load and the fast store, which is
+         * not saved, is rebuilt from their keys. Throws std::runtime_error, and
+         * leaves the queue empty, if the file is invalid or holds a key twice.
+         */
+        void load(const std::string& path)
+        {
+            clear();
+            try
+            {
+                Heap::loadNodes(path, [this, &path](Node* x) {
+                    if(!probe().insert(x->key, x))
+                    {
+                        throw std::runtime_error("[Error]: " + path + " holds a key twice");
+                    }
+                });
+            }
+            catch(...)
+            {
+                clear();
+                throw;
+            }
         }
 
        private:
-        Map m_fstore;
+        //! \brief Copies the elements of \p other into this empty queue, which stays empty if a copy throws
+        void copyFrom(const FiboQueue& other)
+        {
+            auto rebase = Heap::copyNodes(other);
+            try
+            {
+                m_fstore.assign(other.m_fstore, rebase);
+            }
+            catch(...)
+            {
+                Heap::clear();
+                throw;
+            }
+        }
+
+        //! \returns The fast store, counting a probe
+        NodeStore& probe()
+        {
+            Heap::onProbe();
+            return m_fstore;
+        }
+
+        //! \see probe
+        const NodeStore& probe() const
+        {
+            Heap::onProbe();
+            return m_fstore;
+        }
+
+        NodeStore m_fstore;
+        //! Scratch list of the resolved nodes for decreasePriorityBatch()
+        std::vector<std::pair<Node*, PriorityType>> m_batch;
     };
-}
\ No newline at end of file
+
+    /**!
+     * \brief A FiboQueue for integer keys in [0, N), whose fast store is a flat array
+     *
+     * \see DenseNodeStore
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comp = std::less<PriorityType>>
+    using DenseFiboQueue = FiboQueue<PriorityType, KeyType, PayloadType, Comp, DenseNodeStore>;
+}  // namespace fiboheap
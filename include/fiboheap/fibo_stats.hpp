@@ -0,0 +1,212 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace fiboheap
+{
+    //! \brief Operations whose latency is recorded by FiboStats
+    enum class StatsOp
+    {
+        Push,      //!< push, emplace
+        Pop,       //!< pop
+        Decrease,  //!< decreasePriority, tryDecrease
+        Update,    //!< updatePriority
+        Erase,     //!< erase, removeNode
+        Upsert,    //!< upsert of FiboQueue
+        Count
+    };
+
+    //! \brief Counters of a FiboStats policy, copied out for a metrics pipeline
+    struct FiboStatsSnapshot
+    {
+        //! Number of latency buckets, bucket b counts the operations that took [2^b, 2^(b+1)) ns
+        static constexpr size_t kBuckets = 32;
+
+        //! Trees linked under another root (fibHeapLink and the degree table)
+        std::uint64_t links = 0;
+        //! Nodes cut from their parent, cascading cuts included
+        std::uint64_t cuts = 0;
+        //! Cuts made by cascadingCut
+        std::uint64_t cascading_cuts = 0;
+        //! Longest chain of cuts made by a single cascadingCut
+        std::uint64_t max_cascade_depth = 0;
+        //! Root lists consolidated into the degree table
+        std::uint64_t consolidations = 0;
+        //! Roots seen by all the consolidations
+        std::uint64_t consolidated_roots = 0;
+        //! Longest root list consolidated at once
+        std::uint64_t max_root_list = 0;
+        //! Highest degree a node reached
+        std::uint64_t max_degree = 0;
+        //! Nodes created by the node pool
+        std::uint64_t nodes_allocated = 0;
+        //! Node creations that made the pool allocate a slab
+        std::uint64_t slabs_allocated = 0;
+        //! Lookups, insertions and removals in the fast store of a queue
+        std::uint64_t store_probes = 0;
+        //! latency[op][b], with op a StatsOp
+        std::array<std::array<std::uint64_t, kBuckets>, static_cast<size_t>(StatsOp::Count)> latency{};
+
+        //! \returns The latency histogram of \p op
+        const std::array<std::uint64_t, kBuckets>& histogram(StatsOp op) const
+        {
+            return latency[static_cast<size_t>(op)];
+        }
+    };
+
+    /**!
+     * \brief Statistics policy that records nothing, the default of FiboHeap and FiboQueue
+     *
+     * It is empty and every hook is an empty inline function, so that a heap
+     * deriving from it has the same size and code as one without statistics.
+     */
+    class NoStats
+    {
+       public:
+        //! Scoped timer that does nothing
+        struct Timer
+        {};
+
+       protected:
+        Timer timer(StatsOp) const noexcept
+        {
+            return {};
+        }
+
+        void onLink(int) noexcept {}
+        void onCut() noexcept {}
+        void onCascade(std::uint64_t) noexcept {}
+        void onConsolidate(std::uint64_t) noexcept {}
+        void onAllocate(bool) noexcept {}
+        void onProbe() const noexcept {}
+    };
+
+    /**!
+     * \brief Statistics policy that counts the internal work of a heap and times its operations
+     *
+     * Counting costs an increment per event. Every public operation is timed
+     * with two clock reads, nested operations (the heap push inside a queue
+     * push) being accounted to the outermost one.
+     */
+    class FiboStats
+    {
+       public:
+        //! Scoped timer adding its lifetime to a latency histogram, unless another one is running
+        class Timer
+        {
+           public:
+            Timer(const FiboStats* stats, StatsOp op)
+                : m_stats(stats->m_timing ? nullptr : stats)
+                , m_op(op)
+            {
+                if(m_stats != nullptr)
+                {
+                    m_stats->m_timing = true;
+                    m_start           = std::chrono::steady_clock::now();
+                }
+            }
+
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+            ~Timer()
+            {
+                if(m_stats != nullptr)
+                {
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+                    size_t b = 0;
+                    for(auto v = static_cast<std::uint64_t>(ns); v > 1 && b + 1 < FiboStatsSnapshot::kBuckets; v >>= 1)
+                    {
+                        ++b;
+                    }
+                    ++m_stats->m_snapshot.latency[static_cast<size_t>(m_op)][b];
+                    m_stats->m_timing = false;
+                }
+            }
+
+           private:
+            const FiboStats* m_stats;
+            StatsOp m_op;
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+        //! \returns A copy of the counters
+        FiboStatsSnapshot snapshot() const
+        {
+            return m_snapshot;
+        }
+
+        //! \brief Sets every counter back to 0
+        void resetStats()
+        {
+            m_snapshot = FiboStatsSnapshot();
+        }
+
+       protected:
+        Timer timer(StatsOp op) const
+        {
+            return Timer(this, op);
+        }
+
+        void onLink(int degree) noexcept
+        {
+            ++m_snapshot.links;
+            m_snapshot.max_degree = std::max(m_snapshot.max_degree, static_cast<std::uint64_t>(degree));
+        }
+
+        void onCut() noexcept
+        {
+            ++m_snapshot.cuts;
+        }
+
+        void onCascade(std::uint64_t depth) noexcept
+        {
+            m_snapshot.cascading_cuts += depth;
+            m_snapshot.max_cascade_depth = std::max(m_snapshot.max_cascade_depth, depth);
+        }
+
+        void onConsolidate(std::uint64_t roots) noexcept
+        {
+            ++m_snapshot.consolidations;
+            m_snapshot.consolidated_roots += roots;
+            m_snapshot.max_root_list = std::max(m_snapshot.max_root_list, roots);
+        }
+
+        void onAllocate(bool slab) noexcept
+        {
+            ++m_snapshot.nodes_allocated;
+            m_snapshot.slabs_allocated += slab;
+        }
+
+        void onProbe() const noexcept
+        {
+            ++m_snapshot.store_probes;
+        }
+
+       private:
+        mutable FiboStatsSnapshot m_snapshot;
+        mutable bool m_timing = false;
+    };
+}  // namespace fiboheap
@@ -0,0 +1,396 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// External
+#include <robin_hood.h>
+
+namespace fiboheap
+{
+    //! \brief Outcome of the upsert and tryDecrease operations of the queues
+    enum class UpdateResult
+    {
+        Inserted,   //!< The key was absent and has been pushed
+        Improved,   //!< The key was present and its priority has been decreased
+        Unchanged,  //!< The key was present with a priority at least as good
+        Absent      //!< The key was absent and nothing was done
+    };
+
+    //! \brief Which element survives when a key is in both queues being melded
+    enum class DuplicatePolicy
+    {
+        KeepBetter,  //!< The element with the better priority, the one of the destination on ties
+        KeepThis,    //!< The element of the destination queue
+        KeepOther    //!< The element of the queue being melded in
+    };
+
+    /**!
+     * \brief Fast store of a queue backed by a hash map from keys to nodes
+     *
+     * A fast store maps the keys of a queue to their nodes. Besides this one,
+     * DenseNodeStore offers the same interface for small integer keys and
+     * KeyOnceNodeStore for large keys.
+     *
+     * \tparam KeyType The type of the keys
+     * \tparam Node The type of the nodes of the queue
+     */
+    template <typename KeyType, typename Node>
+    class HashNodeStore
+    {
+       public:
+        //! \returns The node of \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            auto iter = m_map.find(key);
+            return iter != m_map.end() ? iter->second : nullptr;
+        }
+
+        /**!
+         * \brief Looks up \p key, inserting the node returned by \p make if absent
+         *
+         * The store is probed once. If \p make throws, the key is removed again.
+         *
+         * \returns The node of the key, and whether it was created by \p make
+         */
+        template <typename Make>
+        std::pair<Node*, bool> findOrInsert(const KeyType& key, Make&& make)
+        {
+            auto [iter, inserted] = m_map.try_emplace(key, nullptr);
+            if(inserted)
+            {
+                try
+                {
+                    iter->second = make();
+                }
+                catch(...)
+                {
+                    m_map.erase(iter);
+                    throw;
+                }
+            }
+            return {iter->second, inserted};
+        }
+
+        //! \brief Associates \p x to \p key, \returns false if \p key was already present
+        bool insert(const KeyType& key, Node* x)
+        {
+            return m_map.insert({key, x}).second;
+        }
+
+        //! \brief Removes \p key, \returns false if it was absent
+        bool erase(const KeyType& key)
+        {
+            return m_map.erase(key) != 0;
+        }
+
+        //! \brief Removes \p key with a single lookup, \returns its node, nullptr if it was absent
+        Node* extract(const KeyType& key)
+        {
+            auto iter = m_map.find(key);
+            if(iter == m_map.end())
+            {
+                return nullptr;
+            }
+            Node* x = iter->second;
+            m_map.erase(iter);
+            return x;
+        }
+
+        /**!
+         * \brief Makes this store a copy of \p other, with every node \p x replaced by \p rebase(x)
+         *
+         * The table is copied as a whole then its nodes are rewritten in place,
+         * without hashing the keys again.
+         */
+        template <typename Rebase>
+        void assign(const HashNodeStore& other, const Rebase& rebase)
+        {
+            m_map = other.m_map;
+            for(auto& entry: m_map)
+            {
+                entry.second = rebase(entry.second);
+            }
+        }
+
+        //! \brief Pre-allocates the store for \p n keys
+        void reserve(size_t n)
+        {
+            m_map.reserve(n);
+        }
+
+        //! \brief Removes all the keys, keeping the buckets allocated
+        void clear()
+        {
+            m_map.clear();
+        }
+
+       private:
+        robin_hood::unordered_map<KeyType, Node*> m_map;
+    };
+
+    /**!
+     * \brief Fast store of a queue for integer keys in [0, N), backed by a flat array
+     *
+     * Every operation is an array access. The array grows to the largest key
+     * seen, so memory is proportional to the key universe rather than to the
+     * number of keys stored.
+     *
+     * \tparam KeyType An integral type, keys must be non-negative
+     * \tparam Node The type of the nodes of the queue
+     */
+    template <typename KeyType, typename Node>
+    class DenseNodeStore
+    {
+        static_assert(std::is_integral_v<KeyType>, "DenseNodeStore requires integral keys");
+
+       public:
+        //! \returns The node of \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            size_t i = static_cast<size_t>(key);
+            return i < m_nodes.size() ? m_nodes[i] : nullptr;
+        }
+
+        //! \see HashNodeStore::findOrInsert
+        template <typename Make>
+        std::pair<Node*, bool> findOrInsert(const KeyType& key, Make&& make)
+        {
+            Node*& slot = at(key);
+            if(slot != nullptr)
+            {
+                return {slot, false};
+            }
+            slot = make();
+            return {slot, true};
+        }
+
+        //! \brief Associates \p x to \p key, \returns false if \p key was already present
+        bool insert(const KeyType& key, Node* x)
+        {
+            Node*& slot = at(key);
+            if(slot != nullptr)
+            {
+                return false;
+            }
+            slot = x;
+            return true;
+        }
+
+        //! \brief Removes \p key, \returns false if it was absent
+        bool erase(const KeyType& key)
+        {
+            size_t i = static_cast<size_t>(key);
+            if(i >= m_nodes.size() || m_nodes[i] == nullptr)
+            {
+                return false;
+            }
+            m_nodes[i] = nullptr;
+            return true;
+        }
+
+        //! \see HashNodeStore::extract
+        Node* extract(const KeyType& key)
+        {
+            size_t i = static_cast<size_t>(key);
+            if(i >= m_nodes.size())
+            {
+                return nullptr;
+            }
+            return std::exchange(m_nodes[i], nullptr);
+        }
+
+        //! \see HashNodeStore::assign
+        template <typename Rebase>
+        void assign(const DenseNodeStore& other, const Rebase& rebase)
+        {
+            m_nodes = other.m_nodes;
+            for(Node*& x: m_nodes)
+            {
+                x = rebase(x);
+            }
+        }
+
+        //! \brief Sizes the array for the keys [0, \p n)
+        void reserve(size_t n)
+        {
+            if(n > m_nodes.size())
+            {
+                m_nodes.resize(n, nullptr);
+            }
+        }
+
+        //! \brief Removes all the keys
+        void clear()
+        {
+            std::fill(m_nodes.begin(), m_nodes.end(), nullptr);
+        }
+
+       private:
+        Node*& at(const KeyType& key)
+        {
+            size_t i = static_cast<size_t>(key);
+            if(i >= m_nodes.size())
+            {
+                m_nodes.resize(std::max(i + 1, 2 * m_nodes.size()), nullptr);
+            }
+            return m_nodes[i];
+        }
+
+        std::vector<Node*> m_nodes;
+    };
+
+    /**!
+     * \brief Fast store of a queue that keeps each key only once, inside its node
+     *
+     * The hash set holds nothing but node pointers and hashes and compares them
+     * through node->key, while lookups by key go through heterogeneous find. Keys
+     * are never copied into the store, which saves a key per entry over
+     * HashNodeStore: about half the memory of the entries for large keys such as
+     * long strings. Nodes must be created before they are inserted, so
+     * findOrInsert() probes the set twice when the key is absent: once to find
+     * it, once to insert its new node.
+     *
+     * \tparam KeyType The type of the keys, hashed with robin_hood::hash
+     * \tparam Node The type of the nodes of the queue
+     */
+    template <typename KeyType, typename Node>
+    class KeyOnceNodeStore
+    {
+        struct Hash
+        {
+            using is_transparent = void;
+
+            size_t operator()(const KeyType& key) const
+            {
+                return robin_hood::hash<KeyType>()(key);
+            }
+
+            size_t operator()(const Node* x) const
+            {
+                return robin_hood::hash<KeyType>()(x->key);
+            }
+        };
+
+        struct Equal
+        {
+            using is_transparent = void;
+
+            bool operator()(const Node* x, const Node* y) const
+            {
+                return x->key == y->key;
+            }
+
+            bool operator()(const Node* x, const KeyType& key) const
+            {
+                return x->key == key;
+            }
+
+            bool operator()(const KeyType& key, const Node* x) const
+            {
+                return x->key == key;
+            }
+        };
+
+       public:
+        //! \returns The node of \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            auto iter = m_set.find(key);
+            return iter != m_set.end() ? *iter : nullptr;
+        }
+
+        //! \see HashNodeStore::findOrInsert
+        template <typename Make>
+        std::pair<Node*, bool> findOrInsert(const KeyType& key, Make&& make)
+        {
+            if(auto iter = m_set.find(key); iter != m_set.end())
+            {
+                return {*iter, false};
+            }
+            Node* x = make();
+            m_set.insert(x);
+            return {x, true};
+        }
+
+        //! \brief Inserts \p x, whose key must be \p key, \returns false if \p key was already present
+        bool insert(const KeyType& key, Node* x)
+        {
+            (void)key;
+            return m_set.insert(x).second;
+        }
+
+        //! \brief Removes \p key, \returns false if it was absent
+        bool erase(const KeyType& key)
+        {
+            auto iter = m_set.find(key);
+            if(iter == m_set.end())
+            {
+                return false;
+            }
+            m_set.erase(iter);
+            return true;
+        }
+
+        //! \see HashNodeStore::extract
+        Node* extract(const KeyType& key)
+        {
+            auto iter = m_set.find(key);
+            if(iter == m_set.end())
+            {
+                return nullptr;
+            }
+            Node* x = *iter;
+            m_set.erase(iter);
+            return x;
+        }
+
+        //! \brief Makes this store a copy of \p other, with every node \p x replaced by \p rebase(x), hashing the keys again
+        template <typename Rebase>
+        void assign(const KeyOnceNodeStore& other, const Rebase& rebase)
+        {
+            m_set.clear();
+            m_set.reserve(other.m_set.size());
+            for(Node* x: other.m_set)
+            {
+                m_set.insert(rebase(x));
+            }
+        }
+
+        //! \brief Pre-allocates the store for \p n keys
+        void reserve(size_t n)
+        {
+            m_set.reserve(n);
+        }
+
+        //! \brief Removes all the keys, keeping the buckets allocated
+        void clear()
+        {
+            m_set.clear();
+        }
+
+       private:
+        robin_hood::unordered_flat_set<Node*, Hash, Equal> m_set;
+    };
+}  // namespace fiboheap
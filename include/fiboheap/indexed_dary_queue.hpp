@@ -0,0 +1,400 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local
+#include "fiboheap/dary_node.hpp"
+#include "fiboheap/fibo_node_pool.hpp"
+#include "fiboheap/fibo_store.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Array-backed d-ary heap with a fast store and a position index
+     *
+     * The heap is a contiguous array of (priority, node) entries, so that sifting
+     * compares priorities without dereferencing nodes; each node records its
+     * position in the array, which gives decreasePriority and removeNode from a
+     * handle in O(log_d n). Mirrors the FiboQueue API.
+     *
+     * \tparam KeyType The type being stored
+     * \tparam PayloadType The type of the payload to associate with the key
+     * \tparam Comp A comparison of priorities
+     * \tparam Arity The number of children of each node of the heap
+     * \tparam Store The fast store mapping keys to nodes (HashNodeStore or DenseNodeStore)
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              typename Comp = std::less<PriorityType>,
+              size_t Arity = 4,
+              template <typename, typename> class Store = HashNodeStore>
+    class IndexedDaryQueue
+    {
+        static_assert(Arity >= 2, "IndexedDaryQueue requires an arity of at least 2");
+
+       public:
+        using Node = DaryNode<PriorityType, KeyType, PayloadType>;
+        using NodeStore = Store<KeyType, Node>;
+        //! Element moved out of the queue, (priority, key[, payload])
+        using value_type = std::conditional_t<std::is_void_v<PayloadType>,
+                                              std::tuple<PriorityType, KeyType>,
+                                              std::tuple<PriorityType, KeyType, PayloadType>>;
+
+       private:
+        struct Entry
+        {
+            PriorityType priority;
+            Node* node;
+        };
+
+       public:
+        //! \brief Default Constructor
+        IndexedDaryQueue() = default;
+
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        IndexedDaryQueue(InputIt first, InputIt last)
+        {
+            push_range(first, last);
+        }
+
+        IndexedDaryQueue(const IndexedDaryQueue&) = delete;
+        IndexedDaryQueue& operator=(const IndexedDaryQueue&) = delete;
+
+        //! \brief Destructor
+        ~IndexedDaryQueue() noexcept
+        {
+            deleteNodes();
+        }
+
+        //! \returns If the queue has no elements
+        bool empty() const noexcept
+        {
+            return m_heap.empty();
+        }
+
+        //! \returns The number of elements in the queue
+        size_t size() const noexcept
+        {
+            return m_heap.size();
+        }
+
+        //! \brief Pre-allocates the heap array, the node pool and the fast store for \p n elements
+        void reserve(size_t n)
+        {
+            m_heap.reserve(n);
+            m_pool.reserve(n);
+            m_fstore.reserve(n);
+        }
+
+        //! \returns The minimum node of the queue
+        Node* minimum() const
+        {
+            return m_heap.empty() ? nullptr : m_heap.front().node;
+        }
+
+        //! \returns The node at the top of the queue
+        Node* topNode() const
+        {
+            return minimum();
+        }
+
+        //! \returns The priority at the top of the queue
+        const PriorityType& top() const
+        {
+            return m_heap.front().priority;
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            return m_fstore.find(key);
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* findNode(const KeyType& key) const
+        {
+            return find(key);
+        }
+
+        //! \returns Whether the \p key is in the queue
+        bool contains(const KeyType& key) const
+        {
+            return m_fstore.find(key) != nullptr;
+        }
+
+        //! \brief Removes the top element from the queue
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            removeNode(m_heap.front().node);
+        }
+
+        //! \brief Removes \p x from the queue
+        void removeNode(Node* x)
+        {
+            size_t i = x->pos;
+            Entry e  = std::move(m_heap.back());
+            m_heap.pop_back();
+            if(i < m_heap.size())
+            {
+                bool up   = m_comp(e.priority, x->priority);
+                m_heap[i] = std::move(e);
+                up ? siftUp(i) : siftDown(i);
+            }
+            m_fstore.erase(x->key);
+            m_pool.destroy(x);
+        }
+
+        //! \brief Pushes \p key onto the queue
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Pushes \p key onto the queue, constructing its payload in place from \p args
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            Node* x = create(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            m_fstore.insert(x->key, x);
+            siftUp(x->pos);
+            return x;
+        }
+
+        /**!
+         * \brief Pushes a range of elements onto the queue
+         *
+         * The elements are appended to the heap array, which is then either sifted
+         * element by element or rebuilt bottom-up in O(n) if the range is larger
+         * than what was already in the queue.
+         *
+         * \param first, last The range of tuple-like elements (priority, key[, payload])
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                reserve(size() + static_cast<size_t>(std::distance(first, last)));
+            }
+            size_t begin = size();
+            for(; first != last; ++first)
+            {
+                std::apply(
+                    [this](auto&&... args) {
+                        Node* x = create(std::forward<decltype(args)>(args)...);
+                        m_fstore.insert(x->key, x);
+                    },
+                    *first);
+            }
+            if(size() - begin > begin)
+            {
+                // Floyd's construction, from the last node that has children up to the root
+                for(size_t i = size() > 1 ? (size() - 2) / Arity + 1 : 0; i-- > 0;)
+                {
+                    siftDown(i);
+                }
+            }
+            else
+            {
+                for(size_t i = begin; i < size(); ++i)
+                {
+                    siftUp(i);
+                }
+            }
+        }
+
+        /**!
+         * \brief Decrease the priority of a node in the queue
+         *
+         * \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+         */
+        bool decreasePriority(Node* x, PriorityType new_priority)
+        {
+            if(m_comp(x->priority, new_priority))
+            {
+                return false;
+            }
+            x->priority = new_priority;
+            m_heap[x->pos].priority = std::move(new_priority);
+            siftUp(x->pos);
+            return true;
+        }
+
+        //! \see FiboQueue::upsert
+        template <typename... Payload>
+        UpdateResult upsert(KeyType key, PriorityType priority, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "upsert takes at most one payload");
+            auto [x, inserted] = m_fstore.findOrInsert(key, [&]() {
+                return create(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+            });
+            if(inserted)
+            {
+                siftUp(x->pos);
+                return UpdateResult::Inserted;
+            }
+            if(!m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            if constexpr(sizeof...(Payload) == 1)
+            {
+                ((x->payload = std::forward<Payload>(payload)), ...);
+            }
+            return UpdateResult::Improved;
+        }
+
+        //! \see FiboQueue::tryDecrease
+        UpdateResult tryDecrease(const KeyType& key, PriorityType priority)
+        {
+            Node* x = m_fstore.find(key);
+            if(x == nullptr)
+            {
+                return UpdateResult::Absent;
+            }
+            if(!m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            return UpdateResult::Improved;
+        }
+
+        //! \brief Clears all the elements from the queue
+        void clear()
+        {
+            deleteNodes();
+            m_heap.clear();
+            m_fstore.clear();
+        }
+
+       private:
+        //! \brief Creates a node at the end of the heap array, without restoring the heap order
+        template <typename... Args>
+        Node* create(PriorityType priority, KeyType key, Args&&... args)
+        {
+            if(m_heap.size() == m_heap.capacity())
+            {
+                m_heap.reserve(std::max<size_t>(16, 2 * m_heap.capacity()));
+            }
+            Node* x = m_pool.create(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            x->pos  = m_heap.size();
+            m_heap.push_back({x->priority, x});
+            return x;
+        }
+
+        //! \brief Moves the entry at \p i up to its place, moving its parents down
+        void siftUp(size_t i)
+        {
+            Entry e = std::move(m_heap[i]);
+            while(i > 0)
+            {
+                size_t parent = (i - 1) / Arity;
+                if(!m_comp(e.priority, m_heap[parent].priority))
+                {
+                    break;
+                }
+                place(i, std::move(m_heap[parent]));
+                i = parent;
+            }
+            place(i, std::move(e));
+        }
+
+        //! \brief Moves the entry at \p i down to its place, moving its smallest children up
+        void siftDown(size_t i)
+        {
+            Entry e  = std::move(m_heap[i]);
+            size_t n = m_heap.size();
+            for(;;)
+            {
+                size_t first = i * Arity + 1;
+                if(first >= n)
+                {
+                    break;
+                }
+                size_t best = first;
+                size_t last = std::min(first + Arity, n);
+                for(size_t c = first + 1; c < last; ++c)
+                {
+                    if(m_comp(m_heap[c].priority, m_heap[best].priority))
+                    {
+                        best = c;
+                    }
+                }
+                if(!m_comp(m_heap[best].priority, e.priority))
+                {
+                    break;
+                }
+                place(i, std::move(m_heap[best]));
+                i = best;
+            }
+            place(i, std::move(e));
+        }
+
+        void place(size_t i, Entry&& e)
+        {
+            e.node->pos = i;
+            m_heap[i]   = std::move(e);
+        }
+
+        void deleteNodes()
+        {
+            for(Entry& e: m_heap)
+            {
+                m_pool.destroy(e.node);
+            }
+        }
+
+        Comp m_comp;
+        std::vector<Entry> m_heap;
+        FiboNodePool<Node> m_pool;
+        NodeStore m_fstore;
+    };
+
+    /**!
+     * \brief An IndexedDaryQueue for integer keys in [0, N), whose fast store is a flat array
+     *
+     * \see DenseNodeStore
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comp = std::less<PriorityType>, size_t Arity = 4>
+    using DenseDaryQueue = IndexedDaryQueue<PriorityType, KeyType, PayloadType, Comp, Arity, DenseNodeStore>;
+}  // namespace fiboheap
@@ -0,0 +1,259 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fiboheap
+{
+    /**!
+     * \brief Bounded lock-free single producer, single consumer ring buffer
+     *
+     * The producer and consumer indices live on separate cache lines, and each
+     * side caches the last index it read from the other to avoid touching the
+     * other side's line on every call.
+     *
+     * \tparam T The type of the elements
+     */
+    template <typename T>
+    class SpscRing
+    {
+        struct Slot
+        {
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+       public:
+        /**!
+         * \brief Constructor
+         *
+         * \param capacity The number of elements the ring can hold, rounded up to a power of two
+         */
+        explicit SpscRing(size_t capacity)
+            : m_mask(roundUp(capacity) - 1)
+            , m_slots(std::make_unique<Slot[]>(m_mask + 1))
+        {}
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        //! \brief Destructor, destroys the elements left in the ring
+        ~SpscRing() noexcept
+        {
+            consume([](T&&) {});
+        }
+
+        //! \returns The number of elements the ring can hold
+        size_t capacity() const noexcept
+        {
+            return m_mask + 1;
+        }
+
+        //! \brief Producer side, constructs an element from \p args, \returns false if the ring is full
+        template <typename... Args>
+        bool tryPush(Args&&... args)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if(tail - m_head_cache > m_mask)
+            {
+                m_head_cache = m_head.load(std::memory_order_acquire);
+                if(tail - m_head_cache > m_mask)
+                {
+                    return false;
+                }
+            }
+            ::new(static_cast<void*>(m_slots[tail & m_mask].storage)) T(std::forward<Args>(args)...);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**!
+         * \brief Consumer side, moves every available element to \p f and frees its slot
+         *
+         * \returns The number of elements consumed
+         */
+        template <typename F>
+        size_t consume(F&& f)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            size_t tail = m_tail.load(std::memory_order_acquire);
+            for(size_t i = head; i != tail; ++i)
+            {
+                T* x = std::launder(reinterpret_cast<T*>(m_slots[i & m_mask].storage));
+                f(std::move(*x));
+                x->~T();
+            }
+            m_head.store(tail, std::memory_order_release);
+            return tail - head;
+        }
+
+       private:
+        static size_t roundUp(size_t n)
+        {
+            size_t p = 1;
+            while(p < n)
+            {
+                p <<= 1;
+            }
+            return p;
+        }
+
+        size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+        //! Next slot to write, written by the producer
+        alignas(64) std::atomic<size_t> m_tail{0};
+        //! Last value of m_head seen by the producer
+        size_t m_head_cache = 0;
+        //! Next slot to read, written by the consumer
+        alignas(64) std::atomic<size_t> m_head{0};
+    };
+
+    /**!
+     * \brief Multiple producers, single consumer front-end of a queue
+     *
+     * Every producer owns a lock-free ring buffer, so producers never wait on each
+     * other nor on heap operations (only on their own ring being full). The
+     * consumer owns the queue: before each top() or pop(), it drains the rings and
+     * inserts everything they held with a single push_range, which for FiboHeap
+     * and FiboQueue is a single root list splice.
+     *
+     * \tparam Queue The queue fed by the producers (FiboQueue, FiboHeap, ...), it
+     * needs a value_type and push_range
+     */
+    template <typename Queue>
+    class IngestQueue
+    {
+       public:
+        using value_type = typename Queue::value_type;
+
+        //! Capacity of the ring of each producer by default
+        static constexpr size_t kDefaultRingCapacity = 1024;
+
+        /**!
+         * \brief Constructor
+         *
+         * \param producers The number of producers, identified by [0, \p producers)
+         * \param ring_capacity The number of elements each producer can have in flight
+         */
+        explicit IngestQueue(size_t producers, size_t ring_capacity = kDefaultRingCapacity)
+        {
+            m_rings.reserve(producers);
+            for(size_t i = 0; i < producers; ++i)
+            {
+                m_rings.push_back(std::make_unique<SpscRing<value_type>>(ring_capacity));
+            }
+        }
+
+        //! \returns The number of producers
+        size_t producers() const noexcept
+        {
+            return m_rings.size();
+        }
+
+        /**!
+         * \brief Producer side, submits an element (priority, key[, payload]) without waiting
+         *
+         * May be called concurrently by different producers, each with its own \p producer.
+         *
+         * \returns false if the ring of \p producer is full
+         */
+        template <typename... Args>
+        bool tryPush(size_t producer, Args&&... args)
+        {
+            return m_rings[producer]->tryPush(std::forward<Args>(args)...);
+        }
+
+        //! \brief Producer side, submits an element, yielding while the ring of \p producer is full
+        template <typename... Args>
+        void push(size_t producer, Args&&... args)
+        {
+            while(!tryPush(producer, args...))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        /**!
+         * \brief Consumer side, moves everything submitted so far into the queue
+         *
+         * \returns The number of elements moved
+         */
+        size_t drain()
+        {
+            for(auto& ring: m_rings)
+            {
+                ring->consume([this](value_type&& v) { m_batch.push_back(std::move(v)); });
+            }
+            size_t n = m_batch.size();
+            if(n != 0)
+            {
+                m_queue.push_range(std::make_move_iterator(m_batch.begin()), std::make_move_iterator(m_batch.end()));
+                m_batch.clear();
+            }
+            return n;
+        }
+
+        //! \brief Consumer side, \returns If the queue is empty once drained
+        bool empty()
+        {
+            drain();
+            return m_queue.empty();
+        }
+
+        //! \brief Consumer side, \returns The node at the top of the queue once drained
+        auto topNode()
+        {
+            drain();
+            return m_queue.topNode();
+        }
+
+        //! \brief Consumer side, \returns The priority at the top of the queue once drained
+        decltype(auto) top()
+        {
+            drain();
+            return m_queue.top();
+        }
+
+        //! \brief Consumer side, removes the top element of the queue once drained
+        void pop()
+        {
+            drain();
+            m_queue.pop();
+        }
+
+        //! \brief Consumer side, \returns The queue, holding what was drained so far
+        Queue& queue() noexcept
+        {
+            return m_queue;
+        }
+
+       private:
+        std::vector<std::unique_ptr<SpscRing<value_type>>> m_rings;
+        //! Scratch list of the elements moved out of the rings by drain()
+        std::vector<value_type> m_batch;
+        Queue m_queue;
+    };
+}  // namespace fiboheap
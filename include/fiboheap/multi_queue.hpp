@@ -0,0 +1,274 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+// External
+#include <robin_hood.h>
+
+// Local
+#include "fiboheap/fibo_heap.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Test and test-and-set lock, yielding to the scheduler after a few spins
+     *
+     * Meets the Lockable requirements, so it works with std::lock_guard and std::unique_lock.
+     */
+    class SpinLock
+    {
+       public:
+        //! Number of failed acquisition attempts before yielding
+        static constexpr int kSpins = 64;
+
+        void lock() noexcept
+        {
+            while(!try_lock())
+            {
+                for(int spins = 0; m_locked.load(std::memory_order_relaxed);)
+                {
+                    if(++spins == kSpins)
+                    {
+                        std::this_thread::yield();
+                        spins = 0;
+                    }
+                }
+            }
+        }
+
+        bool try_lock() noexcept
+        {
+            return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() noexcept
+        {
+            m_locked.store(false, std::memory_order_release);
+        }
+
+       private:
+        std::atomic<bool> m_locked{false};
+    };
+
+    /**!
+     * \brief Concurrent relaxed priority queue made of locked FiboHeap shards
+     *
+     * MultiQueue of Rihani, Sanders and Dementiev (2015) "MultiQueues: Simple Relaxed
+     * Concurrent Priority Queues," SPAA '15, pp. 80-82. push goes to a random shard,
+     * pop takes the better top of two random shards, so that threads rarely contend
+     * on the same lock. Pops are relaxed: the popped element is not always the
+     * minimum, but its expected rank is O(number of shards).
+     *
+     * All the operations are safe to call concurrently. Handles returned by push
+     * know their shard and the generation of their element: as any thread may
+     * pop the element and its node be reused by a later push, each shard maps
+     * its live nodes to their generation, and decreasePriority looks the handle
+     * up there under the shard lock instead of trusting the node pointer.
+     *
+     * \tparam PriorityType The type used to represent the priority of the nodes
+     * \tparam KeyType The type used for the identifier of the payloads
+     * \tparam PayloadType The data to store with each node, void for none
+     * \tparam Comparator A comparison of priorities
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comparator = std::less<PriorityType>>
+    class MultiQueue
+    {
+        using Heap = FiboHeap<PriorityType, KeyType, PayloadType, Comparator>;
+
+       public:
+        using Node = FiboNode<PriorityType, KeyType, PayloadType>;
+        using value_type = typename Heap::value_type;
+
+        //! \brief Node of an element, the shard holding it and the generation telling the element from later users of the node
+        struct Handle
+        {
+            Node* node;
+            size_t shard;
+            std::uint64_t generation;
+        };
+
+        //! Number of shards per thread of a default constructed queue
+        static constexpr size_t kShardsPerThread = 2;
+
+        /**!
+         * \brief Constructor
+         *
+         * \param shards The number of shards, at least 2, by default kShardsPerThread per hardware thread
+         */
+        explicit MultiQueue(size_t shards = kShardsPerThread * std::max(1u, std::thread::hardware_concurrency()))
+            : m_num_shards(std::max<size_t>(shards, 2))
+            , m_shards(std::make_unique<Shard[]>(m_num_shards))
+            , m_size(0)
+        {}
+
+        //! \returns The number of elements, exact only when no operation is running
+        size_t size() const noexcept
+        {
+            return m_size.load(std::memory_order_relaxed);
+        }
+
+        //! \returns If the queue has no elements, exact only when no operation is running
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        //! \returns The number of shards
+        size_t shardCount() const noexcept
+        {
+            return m_num_shards;
+        }
+
+        //! \brief Pushes an element onto a random shard
+        template <typename... Payload>
+        Handle push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Pushes an element onto a random shard, constructing its payload in place from \p args
+        template <typename... Args>
+        Handle emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            size_t i = randomShard();
+            Shard& s = m_shards[i];
+            std::lock_guard<SpinLock> guard(s.lock);
+            Node* x = s.emplace(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            return {x, i, s.track(x)};
+        }
+
+        /**!
+         * \brief Removes the better of the tops of two random shards
+         *
+         * If both shards are empty, the other shards are tried in turn.
+         *
+         * \returns The element removed, nothing if every shard was found empty
+         */
+        std::optional<value_type> tryPop()
+        {
+            size_t i = randomShard();
+            size_t j = randomShard();
+            while(j == i)
+            {
+                j = randomShard();
+            }
+            // Locks are always taken in shard order
+            Shard& a = m_shards[std::min(i, j)];
+            Shard& b = m_shards[std::max(i, j)];
+            {
+                std::lock_guard<SpinLock> guard_a(a.lock);
+                std::lock_guard<SpinLock> guard_b(b.lock);
+                Shard* best = &a;
+                if(a.empty() || (!b.empty() && m_comp(b.top(), a.top())))
+                {
+                    best = &b;
+                }
+                if(!best->empty())
+                {
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    return best->popValue();
+                }
+            }
+            for(size_t k = 0; k < m_num_shards; ++k)
+            {
+                Shard& s = m_shards[k];
+                std::lock_guard<SpinLock> guard(s.lock);
+                if(!s.empty())
+                {
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    return s.popValue();
+                }
+            }
+            return std::nullopt;
+        }
+
+        /**!
+         * \brief Decrease the priority of the element of \p h, locking its shard only
+         *
+         * \returns false, leaving the queue untouched, if the element has been popped or
+         * \p new_priority is greater than the current one
+         */
+        bool decreasePriority(Handle h, PriorityType new_priority)
+        {
+            Shard& s = m_shards[h.shard];
+            std::lock_guard<SpinLock> guard(s.lock);
+            return s.isLive(h) && s.decreasePriority(h.node, std::move(new_priority));
+        }
+
+       private:
+        //! \brief A heap, the generations of its live nodes and its lock, on their own cache lines
+        struct alignas(64) Shard : public Heap
+        {
+            //! \returns The generation given to the new node \p x
+            std::uint64_t track(Node* x)
+            {
+                live[x] = ++generation;
+                return generation;
+            }
+
+            //! \returns Whether the element of \p h is still in the shard, without dereferencing its node
+            bool isLive(const Handle& h) const
+            {
+                auto it = live.find(h.node);
+                return it != live.end() && it->second == h.generation;
+            }
+
+            value_type popValue()
+            {
+                Node* x = Heap::extractMin();
+                live.erase(x);
+                return Heap::release(x);
+            }
+
+            SpinLock lock;
+            //! Generation of every live node, a node reused by a push gets a new one
+            robin_hood::unordered_flat_map<const Node*, std::uint64_t> live;
+            std::uint64_t generation = 0;
+        };
+
+        //! \returns A shard index from a per thread xorshift generator
+        size_t randomShard() const noexcept
+        {
+            static std::atomic<std::uint64_t> seeds{0x9e3779b97f4a7c15ull};
+            thread_local std::uint64_t state = seeds.fetch_add(0x9e3779b97f4a7c15ull, std::memory_order_relaxed) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<size_t>(state % m_num_shards);
+        }
+
+        size_t m_num_shards;
+        std::unique_ptr<Shard[]> m_shards;
+        std::atomic<size_t> m_size;
+        Comparator m_comp;
+    };
+}  // namespace fiboheap
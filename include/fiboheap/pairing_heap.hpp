@@ -0,0 +1,371 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local
+#include "fiboheap/fibo_node_pool.hpp"
+#include "fiboheap/pairing_node.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Pairing heap with the interface of FiboHeap
+     *
+     * Two-pass pairing heap (Fredman et al. (1986) "The pairing heap: A new form
+     * of self-adjusting heap," Algorithmica 1, pp. 111-129). Nodes are smaller than
+     * FiboNode and decreasePriority only relinks the node under the root, which
+     * tends to win in practice on decrease-key heavy workloads.
+     *
+     * \tparam PriorityType The type used to represent the priority of the nodes
+     * \tparam KeyType The type used for the identifier of the payloads
+     * \tparam PayloadType The data to store with each node, void for none
+     * \tparam Comparator A comparison of priorities
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comparator = std::less<PriorityType>>
+    class PairingHeap
+    {
+       protected:
+        using Node = PairingNode<PriorityType, KeyType, PayloadType>;
+
+       public:
+        //! Element moved out of the heap, (priority, key[, payload])
+        using value_type = std::conditional_t<std::is_void_v<PayloadType>,
+                                              std::tuple<PriorityType, KeyType>,
+                                              std::tuple<PriorityType, KeyType, PayloadType>>;
+
+        //! \brief Default Constructor
+        PairingHeap()
+            : m_n(0)
+            , m_root(nullptr)
+        {}
+
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        PairingHeap(InputIt first, InputIt last)
+            : PairingHeap()
+        {
+            push_range(first, last);
+        }
+
+        //! \brief Destructor
+        ~PairingHeap() noexcept
+        {
+            deleteNodes(m_root);
+        }
+
+        //! \returns If the heap has no elements
+        bool empty() const noexcept
+        {
+            return m_n == 0;
+        }
+
+        //! \returns The number of elements in the heap
+        size_t size() const noexcept
+        {
+            return m_n;
+        }
+
+        //! \returns The number of nodes the heap can hold without allocating
+        size_t capacity() const noexcept
+        {
+            return m_pool.capacity();
+        }
+
+        //! \brief Pre-allocates node storage so that \p n elements can be held without allocating
+        void reserve(size_t n)
+        {
+            m_pool.reserve(n);
+        }
+
+        //! \returns The minimum node of the heap
+        Node* minimum() const
+        {
+            return m_root;
+        }
+
+        //! \returns The node at the top of the heap
+        Node* topNode() const
+        {
+            return minimum();
+        }
+
+        //! \returns The priority at the top of the heap
+        const PriorityType& top() const
+        {
+            return m_root->priority;
+        }
+
+        //! Removes the minimum element
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            m_pool.destroy(extractMin());
+        }
+
+        //! \brief Add a node to the heap, \see FiboHeap::push
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Add a node to the heap, constructing its payload in place, \see FiboHeap::emplace
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            Node* x = m_pool.create(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            insert(x);
+            return x;
+        }
+
+        /**!
+         * \brief Add a range of tuple-like elements (priority, key[, payload]) to the heap
+         *
+         * The nodes are allocated in one block when the size of the range is known.
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                m_pool.reserve(m_pool.size() + static_cast<size_t>(std::distance(first, last)));
+            }
+            for(; first != last; ++first)
+            {
+                std::apply([this](auto&&... args) { emplace(std::forward<decltype(args)>(args)...); }, *first);
+            }
+        }
+
+        /**!
+         * \brief Moves all the elements of \p other into this heap in O(1)
+         *
+         * Node handles of \p other stay valid and now belong to this heap, \p other is left empty.
+         */
+        void meld(PairingHeap&& other)
+        {
+            if(&other == this)
+            {
+                return;
+            }
+            m_pool.merge(std::move(other.m_pool));
+            if(other.m_root != nullptr)
+            {
+                m_root = m_root == nullptr ? other.m_root : link(m_root, other.m_root);
+            }
+            m_n += other.m_n;
+            other.m_root = nullptr;
+            other.m_n    = 0;
+        }
+
+        //! \brief Removes \p x from the heap
+        void removeNode(Node* x)
+        {
+            if(x == m_root)
+            {
+                pop();
+                return;
+            }
+            detach(x);
+            if(Node* c = x->child; c != nullptr)
+            {
+                m_root = link(m_root, combineSiblings(c));
+            }
+            --m_n;
+            m_pool.destroy(x);
+        }
+
+        /**!
+         * \brief Decrease the priority of a node in the heap
+         *
+         * The subtree of \p x is cut from its parent and linked with the root.
+         *
+         * \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+         */
+        bool decreasePriority(Node* x, PriorityType new_priority)
+        {
+            if(m_comp(x->priority, new_priority))
+            {
+                return false;
+            }
+            x->priority = std::move(new_priority);
+            if(x != m_root)
+            {
+                detach(x);
+                m_root = link(m_root, x);
+            }
+            return true;
+        }
+
+        //! \brief Removes all the elements from the heap
+        void clear()
+        {
+            deleteNodes(m_root);
+            m_root = nullptr;
+            m_n    = 0;
+        }
+
+       protected:
+        void insert(Node* x)
+        {
+            m_root = m_root == nullptr ? x : link(m_root, x);
+            ++m_n;
+        }
+
+        //! \brief Links two roots, the one with the larger priority becomes the first child of the other
+        Node* link(Node* a, Node* b)
+        {
+            if(m_comp(b->priority, a->priority))
+            {
+                std::swap(a, b);
+            }
+            b->prev = a;
+            b->next = a->child;
+            if(a->child != nullptr)
+            {
+                a->child->prev = b;
+            }
+            a->child = b;
+            a->next = a->prev = nullptr;
+            return a;
+        }
+
+        //! \brief Cuts the subtree of the non-root node \p x from its parent
+        void detach(Node* x)
+        {
+            if(x->prev->child == x)
+            {
+                x->prev->child = x->next;
+            }
+            else
+            {
+                x->prev->next = x->next;
+            }
+            if(x->next != nullptr)
+            {
+                x->next->prev = x->prev;
+            }
+            x->next = x->prev = nullptr;
+        }
+
+        /**!
+         * \brief Two-pass pairing of the sibling list starting at \p first
+         *
+         * Siblings are linked in pairs from left to right, then the pairs are linked
+         * from right to left into a single tree.
+         *
+         * \returns The root of the resulting tree
+         */
+        Node* combineSiblings(Node* first)
+        {
+            std::vector<Node*>& pairs = m_pairs;
+            for(Node* a = first; a != nullptr;)
+            {
+                Node* b = a->next;
+                if(b == nullptr)
+                {
+                    a->prev = nullptr;
+                    pairs.push_back(a);
+                    break;
+                }
+                Node* next = b->next;
+                pairs.push_back(link(a, b));
+                a = next;
+            }
+            Node* root = pairs.back();
+            for(size_t i = pairs.size() - 1; i-- > 0;)
+            {
+                root = link(pairs[i], root);
+            }
+            pairs.clear();
+            return root;
+        }
+
+        Node* extractMin()
+        {
+            Node* z = m_root;
+            m_root  = z->child != nullptr ? combineSiblings(z->child) : nullptr;
+            z->child = nullptr;
+            --m_n;
+            return z;
+        }
+
+        //! \brief Moves the content of \p x out and frees it
+        value_type release(Node* x)
+        {
+            value_type v = [x]() {
+                if constexpr(std::is_void_v<PayloadType>)
+                {
+                    return value_type(std::move(x->priority), std::move(x->key));
+                }
+                else
+                {
+                    return value_type(std::move(x->priority), std::move(x->key), std::move(x->payload));
+                }
+            }();
+            m_pool.destroy(x);
+            return v;
+        }
+
+        //! \brief Frees the tree rooted at \p x without recursion
+        void deleteNodes(Node* x)
+        {
+            // Every child list is pushed in front of the list of nodes left to free
+            while(x != nullptr)
+            {
+                Node* next = x->next;
+                if(Node* c = x->child; c != nullptr)
+                {
+                    Node* last = c;
+                    while(last->next != nullptr)
+                    {
+                        last = last->next;
+                    }
+                    last->next = next;
+                    next       = c;
+                }
+                m_pool.destroy(x);
+                x = next;
+            }
+        }
+
+        size_t m_n;
+        Node* m_root;
+        Comparator m_comp;
+        FiboNodePool<Node> m_pool;
+        //! Scratch list of the subtrees paired by combineSiblings()
+        std::vector<Node*> m_pairs;
+    };
+}  // namespace fiboheap
@@ -0,0 +1,265 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local
+#include "fiboheap/fibo_store.hpp"
+#include "fiboheap/pairing_heap.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief A pairing heap with an added fast store for retrieving nodes
+     * and decreasing the key's value, \see FiboQueue
+     *
+     * \tparam KeyType The type being stored
+     * \tparam PayloadType The type of the payload to associate with the key
+     * \tparam Comp A comparison of priorities
+     * \tparam Store The fast store mapping keys to nodes (HashNodeStore or DenseNodeStore)
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              typename Comp = std::less<PriorityType>,
+              template <typename, typename> class Store = HashNodeStore>
+    class PairingQueue : public PairingHeap<PriorityType, KeyType, PayloadType, Comp>
+    {
+        using Heap = PairingHeap<PriorityType, KeyType, PayloadType, Comp>;
+       public:
+        using Node = typename Heap::Node;
+        using NodeStore = Store<KeyType, Node>;
+        using value_type = typename Heap::value_type;
+
+        //! \brief Default Constructor
+        PairingQueue() = default;
+
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        PairingQueue(InputIt first, InputIt last)
+        {
+            push_range(first, last);
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            return m_fstore.find(key);
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* findNode(const KeyType& key) const
+        {
+            return find(key);
+        }
+
+        //! \returns Whether the \p key is in the queue
+        bool contains(const KeyType& key) const
+        {
+            return m_fstore.find(key) != nullptr;
+        }
+
+        //! \brief Removes the top element from the queue
+        void pop()
+        {
+            if(Heap::empty())
+            {
+                return;
+            }
+            Node* x = Heap::extractMin();
+            m_fstore.erase(x->key);
+            Heap::m_pool.destroy(x);
+        }
+
+        //! \brief Removes \p x from the queue
+        void removeNode(Node* x)
+        {
+            m_fstore.erase(x->key);
+            Heap::removeNode(x);
+        }
+
+        //! \see FiboQueue::upsert
+        template <typename... Payload>
+        UpdateResult upsert(KeyType key, PriorityType priority, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "upsert takes at most one payload");
+            auto [x, inserted] = m_fstore.findOrInsert(key, [&]() {
+                return Heap::emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+            });
+            if(inserted)
+            {
+                return UpdateResult::Inserted;
+            }
+            if(!Heap::m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            Heap::decreasePriority(x, std::move(priority));
+            if constexpr(sizeof...(Payload) == 1)
+            {
+                ((x->payload = std::forward<Payload>(payload)), ...);
+            }
+            return UpdateResult::Improved;
+        }
+
+        //! \see FiboQueue::tryDecrease
+        UpdateResult tryDecrease(const KeyType& key, PriorityType priority)
+        {
+            Node* x = m_fstore.find(key);
+            if(x == nullptr)
+            {
+                return UpdateResult::Absent;
+            }
+            if(!Heap::m_comp(priority, x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            Heap::decreasePriority(x, std::move(priority));
+            return UpdateResult::Improved;
+        }
+
+        //! \brief Pushes \p key onto the queue
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Pushes \p key onto the queue, constructing its payload in place from \p args
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            Node* x = Heap::emplace(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            m_fstore.insert(x->key, x);
+            return x;
+        }
+
+        //! \see FiboQueue::push_range
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                size_t n = Heap::size() + static_cast<size_t>(std::distance(first, last));
+                m_fstore.reserve(n);
+                Heap::reserve(n);
+            }
+            for(; first != last; ++first)
+            {
+                std::apply([this](auto&&... args) { emplace(std::forward<decltype(args)>(args)...); }, *first);
+            }
+        }
+
+        /**!
+         * \brief Moves all the elements of \p other into this queue
+         *
+         * The heaps are melded in O(1), but the keys of \p other are moved into this
+         * fast store one by one.
+         *
+         * \param policy Which element is kept when a key is in both queues
+         */
+        void meld(PairingQueue&& other, DuplicatePolicy policy = DuplicatePolicy::KeepBetter)
+        {
+            if(&other == this)
+            {
+                return;
+            }
+            m_fstore.reserve(Heap::size() + other.size());
+            std::vector<Node*> nodes;
+            nodes.reserve(other.size());
+            other.collectNodes(nodes);
+            for(Node* x: nodes)
+            {
+                auto [y, inserted] = m_fstore.findOrInsert(x->key, [x]() { return x; });
+                if(inserted)
+                {
+                    continue;
+                }
+                if(policy == DuplicatePolicy::KeepOther
+                   || (policy == DuplicatePolicy::KeepBetter && Heap::m_comp(x->priority, y->priority)))
+                {
+                    m_fstore.erase(y->key);
+                    m_fstore.insert(x->key, x);
+                    Heap::removeNode(y);
+                }
+                else
+                {
+                    other.Heap::removeNode(x);
+                }
+            }
+            other.m_fstore.clear();
+            Heap::meld(std::move(other));
+        }
+
+        //! \brief Pre-allocates the node pool and the fast store for \p n elements
+        void reserve(size_t n)
+        {
+            Heap::reserve(n);
+            m_fstore.reserve(n);
+        }
+
+        //! \brief Clears all the elements from the queue
+        void clear()
+        {
+            Heap::clear();
+            m_fstore.clear();
+        }
+
+       private:
+        //! \brief Appends every node of the heap to \p nodes
+        void collectNodes(std::vector<Node*>& nodes) const
+        {
+            if(Heap::m_root == nullptr)
+            {
+                return;
+            }
+            size_t begin = nodes.size();
+            nodes.push_back(Heap::m_root);
+            for(size_t i = begin; i < nodes.size(); ++i)
+            {
+                for(Node* c = nodes[i]->child; c != nullptr; c = c->next)
+                {
+                    nodes.push_back(c);
+                }
+            }
+        }
+
+        NodeStore m_fstore;
+    };
+
+    /**!
+     * \brief A PairingQueue for integer keys in [0, N), whose fast store is a flat array
+     *
+     * \see DenseNodeStore
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void, typename Comp = std::less<PriorityType>>
+    using DensePairingQueue = PairingQueue<PriorityType, KeyType, PayloadType, Comp, DenseNodeStore>;
+}  // namespace fiboheap
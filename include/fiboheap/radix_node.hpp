@@ -0,0 +1,60 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <utility>
+
+// Local
+#include "fiboheap/fibo_node.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Node for a RadixQueue
+     *
+     * Exposes the same priority, key and payload members as FiboNode. Nodes are
+     * kept in the doubly linked list of their bucket.
+     *
+     * \tparam PriorityType The type used to represent the priority of this node
+     * \tparam KeyType The type used for the identifier for the payload in this node
+     * \tparam PayloadType The data to store with this node, void for none
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType>
+    class RadixNode : public FiboPayload<PayloadType>
+    {
+       public:
+        template <typename... Args>
+        RadixNode(PriorityType priority, KeyType k, Args&&... args)
+            : FiboPayload<PayloadType>(std::forward<Args>(args)...)
+            , priority(std::move(priority))
+            , key(std::move(k))
+            , prev(nullptr)
+            , next(nullptr)
+            , bucket(0)
+        {}
+
+        PriorityType priority;
+        KeyType key;
+        RadixNode *prev;
+        RadixNode *next;
+        //! Index of the bucket holding this node
+        int bucket;
+    };
+}  // namespace fiboheap
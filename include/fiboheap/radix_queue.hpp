@@ -0,0 +1,424 @@
+/**
+ * Fibonacci Heap
+ * Copyright (c) 2014, Emmanuel Benazera beniz@droidnik.fr, All rights reserved.
+ * Copyright (c) 2020, Andrew Messing, All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#pragma once
+
+// Global
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Local
+#include "fiboheap/fibo_node_pool.hpp"
+#include "fiboheap/fibo_store.hpp"
+#include "fiboheap/radix_node.hpp"
+
+namespace fiboheap
+{
+    /**!
+     * \brief Radix heap with a fast store, for monotone non-negative integer priorities
+     *
+     * Implementation follows Ahuja et al. (1990) "Faster algorithms for the shortest
+     * path problem," Journal of the ACM 37(2), pp. 213-223. Elements are kept in
+     * buckets indexed by the highest bit in which their priority differs from the
+     * last popped one, so push and decreasePriority are O(1) and pop is O(log C)
+     * amortized, where C is the largest priority.
+     *
+     * The queue is monotone: no priority pushed, or decreased to, may be smaller
+     * than the last popped one (checked by assertions in debug builds). This holds
+     * for Dijkstra's algorithm with non-negative edge weights.
+     *
+     * \tparam PriorityType An integral type, priorities must be non-negative
+     * \tparam KeyType The type being stored
+     * \tparam PayloadType The type of the payload to associate with the key
+     * \tparam Store The fast store mapping keys to nodes (HashNodeStore or DenseNodeStore)
+     */
+    template <typename PriorityType,
+              typename KeyType,
+              typename PayloadType = void,
+              template <typename, typename> class Store = HashNodeStore>
+    class RadixQueue
+    {
+        static_assert(std::is_integral_v<PriorityType>, "RadixQueue requires integral priorities");
+
+        using Unsigned = std::make_unsigned_t<PriorityType>;
+
+        //! Bucket 0 holds the priorities equal to the last popped one, bucket i > 0 those differing at bit i - 1 at most
+        static constexpr int kBuckets = std::numeric_limits<Unsigned>::digits + 1;
+
+       public:
+        using Node = RadixNode<PriorityType, KeyType, PayloadType>;
+        using NodeStore = Store<KeyType, Node>;
+        //! Element moved out of the queue, (priority, key[, payload])
+        using value_type = std::conditional_t<std::is_void_v<PayloadType>,
+                                              std::tuple<PriorityType, KeyType>,
+                                              std::tuple<PriorityType, KeyType, PayloadType>>;
+
+        //! \brief Default Constructor
+        RadixQueue()
+            : m_n(0)
+            , m_min(nullptr)
+            , m_last(0)
+        {
+            m_buckets.fill(nullptr);
+        }
+
+        /**!
+         * \brief Range Constructor
+         *
+         * \see push_range
+         */
+        template <typename InputIt>
+        RadixQueue(InputIt first, InputIt last)
+            : RadixQueue()
+        {
+            push_range(first, last);
+        }
+
+        RadixQueue(const RadixQueue&) = delete;
+        RadixQueue& operator=(const RadixQueue&) = delete;
+
+        //! \brief Destructor
+        ~RadixQueue() noexcept
+        {
+            deleteNodes();
+        }
+
+        //! \returns If the queue has no elements
+        bool empty() const noexcept
+        {
+            return m_n == 0;
+        }
+
+        //! \returns The number of elements in the queue
+        size_t size() const noexcept
+        {
+            return m_n;
+        }
+
+        //! \returns The last popped priority, the lower bound of the priorities accepted by the queue
+        PriorityType last() const noexcept
+        {
+            return m_last;
+        }
+
+        //! \brief Pre-allocates the node pool and the fast store for \p n elements
+        void reserve(size_t n)
+        {
+            m_pool.reserve(n);
+            m_fstore.reserve(n);
+        }
+
+        //! \returns The minimum node of the queue
+        Node* minimum() const
+        {
+            return m_min;
+        }
+
+        //! \returns The node at the top of the queue
+        Node* topNode() const
+        {
+            return minimum();
+        }
+
+        //! \returns The priority at the top of the queue
+        const PriorityType& top() const
+        {
+            return m_min->priority;
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* find(const KeyType& key) const
+        {
+            return m_fstore.find(key);
+        }
+
+        //! \returns The node associated with the \p key, nullptr if absent
+        Node* findNode(const KeyType& key) const
+        {
+            return find(key);
+        }
+
+        //! \returns Whether the \p key is in the queue
+        bool contains(const KeyType& key) const
+        {
+            return m_fstore.find(key) != nullptr;
+        }
+
+        //! \brief Removes the top element from the queue
+        void pop()
+        {
+            if(empty())
+            {
+                return;
+            }
+            Node* x = extractMin();
+            m_fstore.erase(x->key);
+            m_pool.destroy(x);
+        }
+
+        //! \brief Pushes \p key onto the queue
+        template <typename... Payload>
+        Node* push(PriorityType priority, KeyType key, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "push takes at most one payload, use emplace to construct it in place");
+            return emplace(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+        }
+
+        //! \brief Pushes \p key onto the queue, constructing its payload in place from \p args
+        template <typename... Args>
+        Node* emplace(PriorityType priority, KeyType key, Args&&... args)
+        {
+            assert(priority >= m_last && "RadixQueue priorities must not be smaller than the last popped one");
+            Node* x = m_pool.create(std::move(priority), std::move(key), std::forward<Args>(args)...);
+            m_fstore.insert(x->key, x);
+            insert(x);
+            return x;
+        }
+
+        /**!
+         * \brief Pushes a range of elements onto the queue in a single pass
+         *
+         * \param first, last The range of tuple-like elements (priority, key[, payload])
+         */
+        template <typename InputIt>
+        void push_range(InputIt first, InputIt last)
+        {
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                reserve(m_n + static_cast<size_t>(std::distance(first, last)));
+            }
+            for(; first != last; ++first)
+            {
+                std::apply([this](auto&&... args) { emplace(std::forward<decltype(args)>(args)...); }, *first);
+            }
+        }
+
+        /**!
+         * \brief Decrease the priority of a node in the queue, in O(1)
+         *
+         * \returns false, leaving the node untouched, if \p new_priority is greater than the current one
+         */
+        bool decreasePriority(Node* x, PriorityType new_priority)
+        {
+            assert(new_priority >= m_last && "RadixQueue priorities must not be smaller than the last popped one");
+            if(x->priority < new_priority)
+            {
+                return false;
+            }
+            x->priority = new_priority;
+            if(int b = bucketOf(new_priority); b != x->bucket)
+            {
+                unlink(x);
+                link(x, b);
+            }
+            if(new_priority < m_min->priority)
+            {
+                m_min = x;
+            }
+            return true;
+        }
+
+        //! \see FiboQueue::upsert
+        template <typename... Payload>
+        UpdateResult upsert(KeyType key, PriorityType priority, Payload&&... payload)
+        {
+            static_assert(sizeof...(Payload) <= 1, "upsert takes at most one payload");
+            auto [x, inserted] = m_fstore.findOrInsert(key, [&]() {
+                assert(priority >= m_last && "RadixQueue priorities must not be smaller than the last popped one");
+                return m_pool.create(std::move(priority), std::move(key), std::forward<Payload>(payload)...);
+            });
+            if(inserted)
+            {
+                insert(x);
+                return UpdateResult::Inserted;
+            }
+            if(!(priority < x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            if constexpr(sizeof...(Payload) == 1)
+            {
+                ((x->payload = std::forward<Payload>(payload)), ...);
+            }
+            return UpdateResult::Improved;
+        }
+
+        //! \see FiboQueue::tryDecrease
+        UpdateResult tryDecrease(const KeyType& key, PriorityType priority)
+        {
+            Node* x = m_fstore.find(key);
+            if(x == nullptr)
+            {
+                return UpdateResult::Absent;
+            }
+            if(!(priority < x->priority))
+            {
+                return UpdateResult::Unchanged;
+            }
+            decreasePriority(x, std::move(priority));
+            return UpdateResult::Improved;
+        }
+
+        //! \brief Clears all the elements from the queue, the last popped priority is reset to 0
+        void clear()
+        {
+            deleteNodes();
+            m_fstore.clear();
+            m_n    = 0;
+            m_min  = nullptr;
+            m_last = 0;
+        }
+
+       private:
+        //! \returns The bit width of \p x, 0 for 0
+        static int bitWidth(Unsigned x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return x == 0 ? 0 : std::numeric_limits<unsigned long long>::digits - __builtin_clzll(x);
+#else
+            int w = 0;
+            for(; x != 0; x >>= 1)
+            {
+                ++w;
+            }
+            return w;
+#endif
+        }
+
+        //! \returns The bucket of \p priority relative to the last popped priority
+        int bucketOf(PriorityType priority) const
+        {
+            return bitWidth(static_cast<Unsigned>(priority) ^ static_cast<Unsigned>(m_last));
+        }
+
+        void link(Node* x, int b)
+        {
+            x->bucket = b;
+            x->prev   = nullptr;
+            x->next   = m_buckets[b];
+            if(x->next != nullptr)
+            {
+                x->next->prev = x;
+            }
+            m_buckets[b] = x;
+        }
+
+        void unlink(Node* x)
+        {
+            if(x->prev != nullptr)
+            {
+                x->prev->next = x->next;
+            }
+            else
+            {
+                m_buckets[x->bucket] = x->next;
+            }
+            if(x->next != nullptr)
+            {
+                x->next->prev = x->prev;
+            }
+        }
+
+        void insert(Node* x)
+        {
+            link(x, bucketOf(x->priority));
+            if(m_min == nullptr || x->priority < m_min->priority)
+            {
+                m_min = x;
+            }
+            ++m_n;
+        }
+
+        /**!
+         * \brief Removes the minimum node from the buckets
+         *
+         * The minimum becomes the last popped priority. The other nodes of its bucket
+         * all differ from it below the bit of that bucket and are redistributed into
+         * lower buckets, the nodes of the higher buckets are left where they are.
+         * The new minimum is the head of bucket 0 if any, otherwise the minimum of
+         * the first non-empty bucket, which the next pop redistributes.
+         */
+        Node* extractMin()
+        {
+            Node* z = m_min;
+            unlink(z);
+            m_last = z->priority;
+            if(int b = z->bucket; b != 0)
+            {
+                Node* x      = m_buckets[b];
+                m_buckets[b] = nullptr;
+                while(x != nullptr)
+                {
+                    Node* next = x->next;
+                    link(x, bucketOf(x->priority));
+                    x = next;
+                }
+            }
+            m_min = m_buckets[0];
+            for(int b = 1; m_min == nullptr && b < kBuckets; ++b)
+            {
+                for(Node* x = m_buckets[b]; x != nullptr; x = x->next)
+                {
+                    if(m_min == nullptr || x->priority < m_min->priority)
+                    {
+                        m_min = x;
+                    }
+                }
+            }
+            --m_n;
+            return z;
+        }
+
+        void deleteNodes()
+        {
+            for(Node*& head: m_buckets)
+            {
+                while(head != nullptr)
+                {
+                    Node* next = head->next;
+                    m_pool.destroy(head);
+                    head = next;
+                }
+            }
+        }
+
+        size_t m_n;
+        Node* m_min;
+        //! Last popped priority
+        PriorityType m_last;
+        //! Head of the list of nodes of each bucket
+        std::array<Node*, kBuckets> m_buckets;
+        FiboNodePool<Node> m_pool;
+        NodeStore m_fstore;
+    };
+
+    /**!
+     * \brief A RadixQueue for integer keys in [0, N), whose fast store is a flat array
+     *
+     * \see DenseNodeStore
+     */
+    template <typename PriorityType, typename KeyType, typename PayloadType = void>
+    using DenseRadixQueue = RadixQueue<PriorityType, KeyType, PayloadType, DenseNodeStore>;
+}  // namespace fiboheap
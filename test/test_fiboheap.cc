@@ -17,12 +17,29 @@
  */
 // global
 #include <assert.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 #include <queue>
+#include <set>
+#include <stdexcept>
 #include <stdlib.h>
+#include <string>
+#include <thread>
+#include <tuple>
 
 // lib
+#include "fiboheap/bucket_queue.hpp"
+#include "fiboheap/compact_fibo_heap.hpp"
+#include "fiboheap/external_queue.hpp"
 #include "fiboheap/fibo_heap.hpp"
 #include "fiboheap/fibo_queue.hpp"
+#include "fiboheap/indexed_dary_queue.hpp"
+#include "fiboheap/ingest_queue.hpp"
+#include "fiboheap/multi_queue.hpp"
+#include "fiboheap/pairing_queue.hpp"
+#include "fiboheap/radix_queue.hpp"
 
 struct lowerI
 {
@@ -82,6 +99,1679 @@ void matchQueues(fiboheap::FiboQueue<int, int> &fh, std::priority_queue<int, std
     assert(fh.empty());
 }
 
+void checkReserve(const int &n)
+{
+    fiboheap::FiboQueue<int, int> fq;
+    fq.reserve(n);
+    size_t capacity = fq.capacity();
+    assert(capacity >= (size_t)n);
+    for(int round = 0; round < 3; round++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            fq.push(rand(), i);
+        }
+        int last = fq.top();
+        while(!fq.empty())
+        {
+            assert(last <= fq.top());
+            last = fq.top();
+            fq.pop();
+        }
+    }
+    assert(fq.capacity() == capacity);
+}
+
+void checkPayload()
+{
+    static_assert(sizeof(fiboheap::FiboNode<int, int, void>) < sizeof(fiboheap::FiboNode<int, int, long>),
+                  "void payloads must not take space in the node");
+
+    fiboheap::FiboQueue<int, int, std::string> fq;
+    fq.emplace(2, 2, 3, 'b');
+    fq.push(1, 1, std::string("a"));
+    assert(fq.topNode()->payload == "a");
+    fq.pop();
+    assert(fq.findNode(2)->payload == "bbb");
+    fq.pop();
+    assert(fq.empty());
+}
+
+void checkCompact(const int &n)
+{
+    fiboheap::CompactFiboHeap<int, int> ch;
+    std::multiset<int> ref;
+    std::vector<fiboheap::CompactFiboHeap<int, int>::Index> handles(n);
+    std::vector<bool> alive(n);
+    for(int round = 0; round < 2; round++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            int r = rand() / 2;
+            handles[i] = ch.push(r, i);
+            alive[i] = true;
+            ref.insert(r);
+        }
+        while(!ch.empty())
+        {
+            // decrease a live element, then pop so that trees and cuts interleave
+            int k = rand() % n;
+            if(alive[k])
+            {
+                int p = ch.priority(handles[k]);
+                int np = p - rand() % 1000;
+                ref.erase(ref.find(p));
+                ref.insert(np);
+                assert(ch.decreasePriority(handles[k], np));
+                assert(!ch.decreasePriority(handles[k], np + 1) && ch.priority(handles[k]) == np);
+            }
+            assert(ch.top() == *ref.begin());
+            alive[ch.key(ch.topIndex())] = false;
+            ref.erase(ref.begin());
+            ch.pop();
+        }
+        assert(ref.empty());
+    }
+
+    // popped payloads are destroyed at once, not when their slot is reused
+    auto shared = std::make_shared<int>(0);
+    fiboheap::CompactFiboHeap<int, int, std::shared_ptr<int>> ph;
+    for(int i = 0; i < n; i++)
+    {
+        ph.push(rand(), i, shared);
+    }
+    for(int i = 0; i < n / 2; i++)
+    {
+        ph.pop();
+    }
+    assert(shared.use_count() == 1 + n - n / 2);
+    ph.push(0, n, shared);
+    assert(shared.use_count() == 2 + n - n / 2 && ph.payload(ph.topIndex()) == shared);
+    // copies and moves construct and destroy the payloads of the elements only
+    {
+        auto pc = ph.clone();
+        assert(shared.use_count() == 2 * (2 + n - n / 2) - 1);
+        auto pm = std::move(pc);
+        assert(pc.empty() && shared.use_count() == 2 * (2 + n - n / 2) - 1);
+        pm.pop();
+        assert(pm.size() == ph.size() - 1);
+    }
+    assert(shared.use_count() == 2 + n - n / 2);
+    ph.clear();
+    assert(shared.use_count() == 1);
+
+    // a payload constructor that throws leaves the slot it was given to the next push
+    struct Picky
+    {
+        explicit Picky(int v)
+            : value(v)
+        {
+            if(v < 0)
+            {
+                throw std::runtime_error("[Error]: negative payload");
+            }
+        }
+
+        int value;
+    };
+    fiboheap::CompactFiboHeap<int, int, Picky> th;
+    auto refused = [&th]() {
+        size_t size = th.size();
+        try
+        {
+            th.emplace(0, 0, -1);
+        }
+        catch(const std::runtime_error &)
+        {
+            return th.size() == size && th.top() == 1;
+        }
+        return false;
+    };
+    th.emplace(1, 1, 1);
+    auto freed = th.emplace(0, 0, 0);
+    th.pop();
+    // from the free list, then from the end of the arrays
+    assert(refused() && refused() && th.emplace(2, 2, 2) == freed);
+    assert(refused() && th.emplace(3, 3, 3) == freed + 1 && th.payload(th.topIndex()).value == 1);
+}
+
+void checkRange(const int &n)
+{
+    std::vector<std::pair<int, int>> seed;
+    std::priority_queue<int, std::vector<int>, lowerI> pqueue;
+    for(int i = 0; i < n; i++)
+    {
+        int r = rand();
+        seed.emplace_back(r, i);
+        pqueue.push(r);
+    }
+    fiboheap::FiboHeap<int, int> fh(seed.begin(), seed.begin() + n / 2);
+    fh.push(seed[n / 2].first, seed[n / 2].second);
+    fh.push_range(seed.begin() + n / 2 + 1, seed.end());
+    assert(fh.size() == (size_t)n);
+    matchHeaps(fh, pqueue);
+
+    fiboheap::FiboQueue<int, int> fq(seed.begin(), seed.end());
+    assert(fq.size() == (size_t)n);
+    for(int i = 0; i < n; i++)
+    {
+        assert(fq.contains(i));
+        pqueue.push(seed[i].first);
+    }
+    matchQueues(fq, pqueue);
+}
+
+void checkPopN(const int &n)
+{
+    fiboheap::FiboQueue<int, int, std::string> fq;
+    std::priority_queue<int, std::vector<int>, lowerI> pqueue;
+    for(int i = 0; i < n; i++)
+    {
+        int r = rand();
+        fq.push(r, i, std::to_string(r));
+        pqueue.push(r);
+    }
+    // pop once so the forest has trees, then drain in batches of varying size
+    assert(fq.top() == pqueue.top());
+    fq.pop();
+    pqueue.pop();
+    std::vector<fiboheap::FiboQueue<int, int, std::string>::value_type> batch;
+    for(size_t k = 1; !fq.empty(); k *= 2)
+    {
+        batch.clear();
+        fq.popN(k, std::back_inserter(batch));
+        assert(batch.size() == std::min(k, batch.size() + fq.size()));
+        for(const auto &e: batch)
+        {
+            assert(std::get<0>(e) == pqueue.top());
+            assert(std::get<2>(e) == std::to_string(pqueue.top()));
+            assert(!fq.contains(std::get<1>(e)));
+            pqueue.pop();
+        }
+        assert(fq.empty() || fq.top() == pqueue.top());
+    }
+    assert(pqueue.empty());
+}
+
+void checkDecreaseBatch(const int &n)
+{
+    fiboheap::FiboQueue<int, int> fq;
+    std::vector<int> priorities(n);
+    for(int i = 0; i < n; i++)
+    {
+        priorities[i] = rand() / 2;
+        fq.push(priorities[i], i);
+    }
+    // pop a few so that the forest has deep trees to cut from
+    std::vector<fiboheap::FiboQueue<int, int>::value_type> popped;
+    fq.popN(n / 10, std::back_inserter(popped));
+    for(const auto &e: popped)
+    {
+        priorities[std::get<1>(e)] = -1;
+    }
+    for(int round = 0; round < 10; round++)
+    {
+        std::vector<std::pair<int, int>> batch;
+        std::vector<int> rejected;
+        size_t expected = 0;
+        for(int j = 0; j < n / 10; j++)
+        {
+            int k = rand() % (n + 10);
+            bool alive = k < n && priorities[k] >= 0;
+            bool seen = false;
+            for(const auto &b: batch)
+            {
+                seen = seen || b.first == k;
+            }
+            if(seen)
+            {
+                continue;
+            }
+            int np = alive && rand() % 4 ? priorities[k] - rand() % 100000 : (alive ? priorities[k] + 1 : 0);
+            batch.emplace_back(k, np);
+            if(alive && np <= priorities[k])
+            {
+                priorities[k] = np;
+                ++expected;
+            }
+        }
+        size_t decreased = fq.decreasePriorityBatch(batch.begin(), batch.end(), std::back_inserter(rejected));
+        assert(decreased == expected);
+        assert(decreased + rejected.size() == batch.size());
+    }
+    std::multiset<int> ref;
+    for(int p: priorities)
+    {
+        if(p >= 0)
+        {
+            ref.insert(p);
+        }
+    }
+    for(int p: ref)
+    {
+        assert(fq.top() == p);
+        fq.pop();
+    }
+    assert(fq.empty());
+}
+
+void checkUpsert()
+{
+    using fiboheap::UpdateResult;
+    fiboheap::FiboQueue<int, int, int> fq;
+    assert(fq.upsert(1, 10, 100) == UpdateResult::Inserted);
+    assert(fq.upsert(2, 20, 200) == UpdateResult::Inserted);
+    assert(fq.upsert(1, 15, 101) == UpdateResult::Unchanged);
+    assert(fq.findNode(1)->payload == 100);
+    assert(fq.upsert(2, 5, 201) == UpdateResult::Improved);
+    assert(fq.findNode(2)->payload == 201);
+    assert(fq.tryDecrease(3, 1) == UpdateResult::Absent);
+    assert(fq.tryDecrease(1, 10) == UpdateResult::Unchanged);
+    assert(fq.tryDecrease(1, 7) == UpdateResult::Improved);
+    assert(fq.size() == 2);
+    assert(fq.top() == 5 && fq.topNode()->key == 2);
+    fq.pop();
+    assert(fq.top() == 7 && fq.topNode()->key == 1);
+    fq.pop();
+    assert(fq.empty());
+}
+
+void checkDense(const int &n)
+{
+    fiboheap::DenseFiboQueue<int, int> fq;
+    std::vector<int> priorities(n, -1);
+    for(int i = 0; i < 4 * n; i++)
+    {
+        int k = rand() % n;
+        int p = rand();
+        fq.upsert(k, p);
+        priorities[k] = priorities[k] < 0 ? p : std::min(priorities[k], p);
+    }
+    std::multiset<int> ref;
+    for(int k = 0; k < n; k++)
+    {
+        assert(fq.contains(k) == (priorities[k] >= 0));
+        if(priorities[k] >= 0)
+        {
+            assert(fq.find(k)->priority == priorities[k]);
+            ref.insert(priorities[k]);
+        }
+    }
+    assert(fq.find(n + 1) == nullptr);
+    for(int p: ref)
+    {
+        assert(fq.top() == p);
+        int k = fq.topNode()->key;
+        fq.pop();
+        assert(!fq.contains(k));
+    }
+    assert(fq.empty());
+}
+
+void checkPairing(const int &n)
+{
+    fiboheap::PairingHeap<int, int> ph;
+    std::multiset<int> ref;
+    std::vector<fiboheap::PairingHeap<int, int>::value_type> items;
+    for(int i = 0; i < n; i++)
+    {
+        items.emplace_back(rand(), i);
+    }
+    ph.push_range(items.begin(), items.end());
+    std::vector<fiboheap::PairingNode<int, int, void> *> nodes;
+    for(int i = 0; i < n; i++)
+    {
+        int p = rand();
+        nodes.push_back(ph.push(p, n + i));
+        ref.insert(p);
+    }
+    for(auto &item: items)
+    {
+        ref.insert(std::get<0>(item));
+    }
+    for(int i = 0; i < n; i += 2)
+    {
+        int p = nodes[i]->priority;
+        int np = p - rand() % 1000;
+        assert(ph.decreasePriority(nodes[i], np));
+        assert(!ph.decreasePriority(nodes[i], np + 1));
+        ref.erase(ref.find(p));
+        ref.insert(np);
+    }
+    for(int i = 1; i < n; i += 4)
+    {
+        ref.erase(ref.find(nodes[i]->priority));
+        ph.removeNode(nodes[i]);
+    }
+    fiboheap::PairingHeap<int, int> other;
+    for(int i = 0; i < n; i++)
+    {
+        int p = rand();
+        other.push(p, 2 * n + i);
+        ref.insert(p);
+    }
+    ph.meld(std::move(other));
+    assert(other.empty() && ph.size() == ref.size());
+    for(int i = 0; i < n / 2; i++)
+    {
+        other.push(i, i);
+    }
+    for(int p: ref)
+    {
+        assert(ph.top() == p);
+        ph.pop();
+    }
+    assert(ph.empty());
+
+    fiboheap::PairingQueue<int, int> pq;
+    fiboheap::PairingQueue<int, int> pq2;
+    assert(pq.upsert(1, 10) == fiboheap::UpdateResult::Inserted);
+    assert(pq.upsert(2, 20) == fiboheap::UpdateResult::Inserted);
+    assert(pq.upsert(1, 5) == fiboheap::UpdateResult::Improved);
+    assert(pq.tryDecrease(3, 1) == fiboheap::UpdateResult::Absent);
+    pq2.push(7, 1);
+    pq2.push(3, 2);
+    pq2.push(9, 4);
+    pq.meld(std::move(pq2));
+    assert(pq2.empty() && !pq2.contains(4));
+    assert(pq.size() == 3 && pq.find(1)->priority == 5 && pq.find(2)->priority == 3);
+    pq.removeNode(pq.find(4));
+    assert(!pq.contains(4));
+    assert(pq.top() == 3 && pq.topNode()->key == 2);
+    pq.pop();
+    assert(pq.top() == 5 && !pq.contains(2));
+    pq.pop();
+    assert(pq.empty());
+}
+
+void checkRadix(const int &n)
+{
+    fiboheap::RadixQueue<int, int> rq;
+    fiboheap::DenseRadixQueue<unsigned, int, int> drq;
+    std::vector<int> priorities(n, -1);
+    int last = 0;
+    for(int round = 0; round < 4; round++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            int k = rand() % n;
+            // p = k mod n, so that priorities are distinct and both queues pop the same keys
+            int p = (last / n + 1 + rand() % 100000) * n + k;
+            rq.upsert(k, p);
+            drq.upsert(k, p, k);
+            priorities[k] = priorities[k] < 0 ? p : std::min(priorities[k], p);
+        }
+        assert(rq.tryDecrease(n, last) == fiboheap::UpdateResult::Absent);
+        for(int i = 0; i < n / 2 && !rq.empty(); i++)
+        {
+            assert(rq.top() >= last && rq.last() == last);
+            assert((int)drq.top() == rq.top());
+            int k = rq.topNode()->key;
+            assert(priorities[k] == rq.top());
+            assert(drq.find(k)->priority == drq.top() && drq.find(k)->payload == k);
+            last = rq.top();
+            priorities[k] = -1;
+            rq.pop();
+            drq.pop();
+            assert(!rq.contains(k) && !drq.contains(k));
+        }
+    }
+    assert(rq.size() == drq.size());
+    while(!rq.empty())
+    {
+        assert(rq.top() >= last);
+        last = rq.top();
+        rq.pop();
+    }
+    rq.push(last + 10, 0);
+    assert(rq.decreasePriority(rq.find(0), last) && rq.top() == last);
+    drq.clear();
+    assert(drq.empty() && drq.last() == 0);
+}
+
+template <typename Queue>
+void checkDaryQueue(const int &n)
+{
+    std::vector<std::tuple<int, int>> items;
+    for(int k = 0; k < n; k++)
+    {
+        items.emplace_back(rand(), k);
+    }
+    Queue q(items.begin(), items.begin() + n / 2);
+    q.push_range(items.begin() + n / 2, items.end());
+    std::vector<int> priorities(n);
+    for(auto &item: items)
+    {
+        priorities[std::get<1>(item)] = std::get<0>(item);
+    }
+    for(int i = 0; i < 2 * n; i++)
+    {
+        int k = rand() % n;
+        int p = rand();
+        if(priorities[k] < 0)
+        {
+            continue;
+        }
+        auto result = q.upsert(k, p);
+        assert((result == fiboheap::UpdateResult::Improved) == (p < priorities[k]));
+        priorities[k] = std::min(priorities[k], p);
+        if(i % 5 == 0)
+        {
+            q.removeNode(q.find(k));
+            priorities[k] = -1;
+        }
+    }
+    std::multiset<int> ref;
+    for(int k = 0; k < n; k++)
+    {
+        assert(q.contains(k) == (priorities[k] >= 0));
+        if(priorities[k] >= 0)
+        {
+            assert(q.find(k)->priority == priorities[k]);
+            ref.insert(priorities[k]);
+        }
+    }
+    assert(q.size() == ref.size());
+    for(int p: ref)
+    {
+        assert(q.top() == p && q.topNode()->priority == p);
+        q.pop();
+    }
+    assert(q.empty());
+}
+
+void checkDary(const int &n)
+{
+    checkDaryQueue<fiboheap::IndexedDaryQueue<int, int>>(n);
+    checkDaryQueue<fiboheap::IndexedDaryQueue<int, int, void, std::less<int>, 2>>(n);
+    checkDaryQueue<fiboheap::DenseDaryQueue<int, int, void, std::less<int>, 8>>(n);
+}
+
+void checkBucket(const int &n)
+{
+    const int range = 5000;
+    fiboheap::BucketQueue<int, int> bq(range);
+    fiboheap::DenseBucketQueue<unsigned, int, int> dbq(range);
+    std::vector<int> priorities(n, -1);
+    for(int i = 0; i < 4 * n; i++)
+    {
+        int k = rand() % n;
+        int p = rand() % range;
+        bq.upsert(k, p);
+        dbq.upsert(k, p, -k);
+        priorities[k] = priorities[k] < 0 ? p : std::min(priorities[k], p);
+        if(i % 7 == 0)
+        {
+            bq.removeNode(bq.find(k));
+            dbq.removeNode(dbq.find(k));
+            priorities[k] = -1;
+        }
+    }
+    bool thrown = false;
+    try
+    {
+        bq.push(range, n);
+    }
+    catch(const std::out_of_range &)
+    {
+        thrown = true;
+    }
+    assert(thrown && !bq.contains(n));
+    std::multiset<int> ref;
+    for(int k = 0; k < n; k++)
+    {
+        assert(bq.contains(k) == (priorities[k] >= 0));
+        if(priorities[k] >= 0)
+        {
+            assert(bq.find(k)->priority == priorities[k]);
+            assert(dbq.find(k)->payload == -k);
+            ref.insert(priorities[k]);
+        }
+    }
+    for(int p: ref)
+    {
+        assert(bq.top() == p && (int)dbq.top() == p);
+        int k = bq.topNode()->key;
+        bq.pop();
+        dbq.pop();
+        assert(!bq.contains(k));
+    }
+    assert(bq.empty() && dbq.empty());
+}
+
+void checkMultiQueue(const int &n)
+{
+    fiboheap::MultiQueue<int, int, int> mq(4);
+    auto h = mq.push(100, -1, 7);
+    assert(mq.decreasePriority(h, -10) && !mq.decreasePriority(h, 0));
+    // a pop looks at two shards out of four: retry until the decreased element shows up
+    for(;;)
+    {
+        auto v = mq.tryPop();
+        assert(v.has_value());
+        if(std::get<1>(*v) == -1)
+        {
+            assert(std::get<0>(*v) == -10 && std::get<2>(*v) == 7);
+            break;
+        }
+    }
+    while(mq.tryPop())
+    {
+    }
+    assert(mq.empty());
+
+    const int threads = 4;
+    std::vector<std::thread> workers;
+    std::vector<std::vector<int>> popped(threads);
+    for(int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t] {
+            for(int i = 0; i < n; i++)
+            {
+                int k = t * n + i;
+                auto handle = mq.push(k, k, k);
+                mq.decreasePriority(handle, k - 1);
+                if(i % 2 == 1)
+                {
+                    auto v = mq.tryPop();
+                    assert(v.has_value());
+                    assert(std::get<0>(*v) == std::get<1>(*v) - 1 && std::get<1>(*v) == std::get<2>(*v));
+                    popped[t].push_back(std::get<1>(*v));
+                }
+            }
+        });
+    }
+    for(auto &w: workers)
+    {
+        w.join();
+    }
+    assert(mq.size() == (size_t)(threads * n - threads * (n / 2)));
+    std::set<int> keys;
+    while(auto v = mq.tryPop())
+    {
+        keys.insert(std::get<1>(*v));
+    }
+    for(auto &p: popped)
+    {
+        keys.insert(p.begin(), p.end());
+    }
+    assert(keys.size() == (size_t)(threads * n) && *keys.begin() == 0 && *keys.rbegin() == threads * n - 1);
+    assert(mq.empty());
+
+    // decreases race with pops and with pushes reusing the popped nodes: stale handles must be refused
+    fiboheap::MultiQueue<int, int> rq(4);
+    std::vector<fiboheap::MultiQueue<int, int>::Handle> handles;
+    for(int i = 0; i < n; i++)
+    {
+        handles.push_back(rq.push(2 * n + i, i));
+    }
+    std::atomic<int> running{2};
+    std::vector<std::thread> racers;
+    std::vector<std::vector<std::tuple<int, int>>> out(2);
+    for(int t = 0; t < 2; t++)
+    {
+        racers.emplace_back([&, t] {
+            for(int i = 0; i < n; i++)
+            {
+                auto v = rq.tryPop();
+                assert(v.has_value());
+                out[t].push_back(*v);
+                int k = n + t * n + i;
+                rq.push(4 * n + k, k);
+            }
+            running.fetch_sub(1);
+        });
+        racers.emplace_back([&, t] {
+            for(int i = t; running.load() != 0; i = (i + 7) % n)
+            {
+                rq.decreasePriority(handles[i], -i - 1);
+            }
+        });
+    }
+    for(auto &r: racers)
+    {
+        r.join();
+    }
+    while(auto v = rq.tryPop())
+    {
+        out[0].push_back(*v);
+    }
+    keys.clear();
+    for(auto &o: out)
+    {
+        for(auto [p, k]: o)
+        {
+            assert(keys.insert(k).second);
+            assert(k < n ? (p == 2 * n + k || p == -k - 1) : p == 4 * n + k);
+        }
+    }
+    assert(keys.size() == (size_t)(3 * n));
+}
+
+void checkIngest(const int &n)
+{
+    const int producers = 4;
+    fiboheap::IngestQueue<fiboheap::FiboQueue<int, int, int>> iq(producers, 64);
+    assert(iq.empty());
+    bool pushed = iq.tryPush(producers - 1, 1, -1, 1);
+    assert(pushed && !iq.empty() && iq.top() == 1);
+    iq.pop();
+    assert(iq.empty());
+    std::atomic<int> finished{0};
+    std::vector<std::thread> workers;
+    for(int t = 0; t < producers; t++)
+    {
+        workers.emplace_back([&, t] {
+            for(int i = 0; i < n; i++)
+            {
+                int k = t * n + i;
+                iq.push(t, k * 7919 % n, k, -k);
+            }
+            finished++;
+        });
+    }
+    // pop half of what is available while the producers run, so that their rings keep draining
+    std::set<int> keys;
+    while(finished < producers)
+    {
+        iq.drain();
+        auto &q = iq.queue();
+        if(!q.empty() && q.size() % 2 == 0)
+        {
+            auto *x = q.topNode();
+            assert(x->payload == -x->key && x->priority == q.top());
+            keys.insert(x->key);
+            q.pop();
+        }
+    }
+    for(auto &w: workers)
+    {
+        w.join();
+    }
+    int last = -1;
+    while(!iq.empty())
+    {
+        assert(iq.top() >= last);
+        last = iq.top();
+        keys.insert(iq.topNode()->key);
+        iq.pop();
+    }
+    assert(keys.size() == (size_t)(producers * n));
+}
+
+void checkIncremental(const int &n)
+{
+    for(size_t budget = 1; budget <= 4; budget *= 2)
+    {
+        fiboheap::FiboHeap<int, int> fh;
+        for(int i = 0; i < n; i++)
+        {
+            fh.push(rand(), i);
+        }
+        // switching with a non-empty heap moves its roots to the degree table
+        fh.setConsolidationBudget(budget);
+        assert(fh.consolidationBudget() == budget);
+        std::multiset<int> ref;
+        std::vector<std::tuple<int, int>> items;
+        for(int i = 0; i < n; i++)
+        {
+            items.emplace_back(rand(), n + i);
+        }
+        fh.push_range(items.begin(), items.end());
+        while(!fh.empty())
+        {
+            fh.pop();
+        }
+        // pops are rarer than pushes so that trees grow and decreases cut deep nodes
+        std::vector<fiboheap::FiboNode<int, int, void> *> nodes;
+        std::vector<bool> alive;
+        for(int i = 0; i < 4 * n; i++)
+        {
+            int p = rand();
+            nodes.push_back(fh.push(p, i));
+            alive.push_back(true);
+            ref.insert(p);
+            if(i % 4 == 0)
+            {
+                assert(fh.top() == *ref.begin());
+                alive[fh.topNode()->key] = false;
+                ref.erase(ref.begin());
+                fh.pop();
+            }
+            else
+            {
+                int k = rand() % (i + 1);
+                if(alive[k])
+                {
+                    int np = nodes[k]->priority - rand() % 100000;
+                    ref.erase(ref.find(nodes[k]->priority));
+                    ref.insert(np);
+                    fh.decreasePriority(nodes[k], np);
+                }
+            }
+            assert(fh.size() == ref.size() && (ref.empty() || fh.top() == *ref.begin()));
+        }
+        std::vector<fiboheap::FiboHeap<int, int>::value_type> out;
+        fh.popN(n / 2, std::back_inserter(out));
+        for(auto &v: out)
+        {
+            assert(std::get<0>(v) == *ref.begin());
+            ref.erase(ref.begin());
+        }
+        // back to incremental after popN, then eager for the rest
+        fh.push(-1, -1);
+        ref.insert(-1);
+        assert(fh.top() == -1);
+        fh.pop();
+        ref.erase(ref.begin());
+        fh.setConsolidationBudget(0);
+        for(int p: ref)
+        {
+            assert(fh.top() == p);
+            fh.pop();
+        }
+        assert(fh.empty());
+    }
+
+    // on priority ties, pop() removes the node topNode() returned
+    for(int trial = 0; trial < 200; trial++)
+    {
+        fiboheap::DenseFiboQueue<int, int> tq;
+        tq.setConsolidationBudget(1);
+        for(int i = 0; i < 64; i++)
+        {
+            tq.push(rand() % 1000 + 1, i);
+        }
+        tq.pop();
+        for(int i = 0; i < 10; i++)
+        {
+            tq.tryDecrease(rand() % 64, 0);
+        }
+        while(!tq.empty())
+        {
+            int k = tq.topNode()->key;
+            tq.pop();
+            assert(!tq.contains(k));
+        }
+    }
+
+    fiboheap::DenseFiboQueue<int, int> fq;
+    fq.setConsolidationBudget(2);
+    std::vector<int> priorities(n, -1);
+    for(int i = 0; i < 8 * n; i++)
+    {
+        int k = rand() % n;
+        int p = rand();
+        fq.upsert(k, p);
+        priorities[k] = priorities[k] < 0 ? p : std::min(priorities[k], p);
+        if(i % 3 == 0)
+        {
+            assert(priorities[fq.topNode()->key] == fq.top());
+            priorities[fq.topNode()->key] = -1;
+            fq.pop();
+        }
+    }
+    int last = -1;
+    for(; !fq.empty(); fq.pop())
+    {
+        assert(fq.top() >= last && priorities[fq.topNode()->key] == fq.top());
+        last = fq.top();
+    }
+}
+
+void checkMeld(const int &n)
+{
+    fiboheap::FiboHeap<int, int> fh;
+    fiboheap::FiboHeap<int, int> other;
+    std::multiset<int> ref;
+    std::vector<fiboheap::FiboNode<int, int, void> *> nodes;
+    for(int i = 0; i < n; i++)
+    {
+        int p = rand();
+        fh.push(p, i);
+        ref.insert(p);
+        p = rand();
+        nodes.push_back(other.push(p, n + i));
+        ref.insert(p);
+    }
+    // pops build trees and leave free slots in both pools
+    for(int i = 0; i < n / 10; i++)
+    {
+        ref.erase(ref.find(fh.top()));
+        fh.pop();
+        ref.erase(ref.find(other.top()));
+        nodes[other.topNode()->key - n] = nullptr;
+        other.pop();
+    }
+    other.setConsolidationBudget(2);
+    fh.meld(std::move(other));
+    assert(other.empty() && other.capacity() == 0 && fh.size() == ref.size());
+    // handles of the melded heap stay valid
+    for(int i = 0; i < n; i += 3)
+    {
+        if(nodes[i] != nullptr)
+        {
+            int p  = nodes[i]->priority;
+            int np = p - rand() % 1000;
+            ref.erase(ref.find(p));
+            ref.insert(np);
+            assert(fh.decreasePriority(nodes[i], np));
+        }
+    }
+    for(int i = 0; i < n; i++)
+    {
+        int p = rand();
+        fh.push(p, 2 * n + i);
+        ref.insert(p);
+        other.push(i, i);
+    }
+    fiboheap::FiboHeap<int, int> empty;
+    fiboheap::FiboHeap<int, int> *h = fiboheap::FiboHeap<int, int>::unionFiboHeap(&fh, &empty);
+    assert(fh.empty() && h->size() == ref.size());
+    for(int p: ref)
+    {
+        assert(h->top() == p);
+        h->pop();
+    }
+    delete h;
+
+    // the tail of the slab a melded pool was carving from is handed out once, before and after clear()
+    for(int pushed: {1, 100, n})
+    {
+        fiboheap::FiboHeap<int, int> a, b;
+        std::set<const void *> addresses;
+        addresses.insert(a.push(0, 0));
+        for(int i = 0; i < pushed; i++)
+        {
+            addresses.insert(b.push(i, i));
+        }
+        a.meld(std::move(b));
+        for(int round = 0; round < 2; round++)
+        {
+            for(int i = 0; i < 4 * n; i++)
+            {
+                assert(addresses.insert(a.push(rand(), i)).second);
+            }
+            a.clear();
+            addresses.clear();
+        }
+    }
+
+    using Queue = fiboheap::FiboQueue<int, int>;
+    for(auto policy: {fiboheap::DuplicatePolicy::KeepBetter, fiboheap::DuplicatePolicy::KeepThis, fiboheap::DuplicatePolicy::KeepOther})
+    {
+        Queue fq;
+        Queue fq2;
+        std::vector<int> mine(2 * n, -1);
+        std::vector<int> theirs(2 * n, -1);
+        for(int i = 0; i < n; i++)
+        {
+            int k = rand() % (2 * n);
+            mine[k] = mine[k] < 0 ? rand() : mine[k];
+            fq.upsert(k, mine[k]);
+            k = rand() % (2 * n);
+            theirs[k] = theirs[k] < 0 ? rand() : theirs[k];
+            fq2.upsert(k, theirs[k]);
+        }
+        fq.pop();
+        fq2.pop();
+        std::vector<int> expected(2 * n, -1);
+        for(int k = 0; k < 2 * n; k++)
+        {
+            bool a = fq.contains(k), b = fq2.contains(k);
+            if(a && b)
+            {
+                bool other_wins = policy == fiboheap::DuplicatePolicy::KeepOther
+                                  || (policy == fiboheap::DuplicatePolicy::KeepBetter && theirs[k] < mine[k]);
+                expected[k] = other_wins ? theirs[k] : mine[k];
+            }
+            else if(a || b)
+            {
+                expected[k] = a ? mine[k] : theirs[k];
+            }
+        }
+        fq.meld(std::move(fq2), policy);
+        assert(fq2.empty() && !fq2.contains(fq.topNode()->key));
+        std::set<std::pair<int, int>> order;
+        for(int k = 0; k < 2 * n; k++)
+        {
+            assert(fq.contains(k) == (expected[k] >= 0));
+            if(expected[k] >= 0)
+            {
+                assert(fq.find(k)->priority == expected[k]);
+                order.emplace(expected[k], k);
+            }
+        }
+        assert(fq.size() == order.size());
+        for(auto &e: order)
+        {
+            assert(fq.top() == e.first && fq.topNode()->key == e.second);
+            fq.pop();
+        }
+        assert(fq.empty());
+    }
+}
+
+void checkUpdateErase(const int &n)
+{
+    for(size_t budget: {size_t(0), size_t(2)})
+    {
+        // floating point priorities, for which numeric_limits<double>::min() is positive
+        fiboheap::FiboHeap<double, int> fh;
+        fh.setConsolidationBudget(budget);
+        std::multiset<double> ref;
+        std::vector<fiboheap::FiboNode<double, int, void> *> nodes;
+        for(int i = 0; i < 4 * n; i++)
+        {
+            double p = rand() / double(RAND_MAX) - 0.5;
+            nodes.push_back(fh.push(p, i));
+            ref.insert(p);
+            int k = i % 6 == 4 ? fh.topNode()->key : rand() % (i + 1);
+            fiboheap::FiboNode<double, int, void> *x = nodes[k];
+            if(x == nullptr)
+            {
+                continue;
+            }
+            if(i % 6 == 0)
+            {
+                nodes[fh.topNode()->key] = nullptr;
+                ref.erase(ref.begin());
+                fh.pop();
+            }
+            else if(i % 6 == 1)
+            {
+                ref.erase(ref.find(x->priority));
+                fh.erase(x);
+                nodes[k] = nullptr;
+            }
+            else
+            {
+                // decreases and increases, the minimum itself is increased when i % 6 == 4
+                double np = x->priority + rand() / double(RAND_MAX) - (i % 6 == 4 ? 0.0 : 0.5);
+                ref.erase(ref.find(x->priority));
+                ref.insert(np);
+                fh.updatePriority(x, np);
+            }
+            assert(fh.size() == ref.size() && (ref.empty() || fh.top() == *ref.begin()));
+        }
+        for(double p: ref)
+        {
+            assert(fh.top() == p);
+            fh.pop();
+        }
+        assert(fh.empty());
+    }
+
+    // non-arithmetic priorities
+    fiboheap::FiboQueue<std::string, int> fq;
+    for(int i = 0; i < n; i++)
+    {
+        fq.push(std::to_string(rand()), i);
+    }
+    for(int i = 0; i < n; i += 2)
+    {
+        assert(fq.erase(i));
+        assert(!fq.contains(i) && !fq.erase(i));
+    }
+    fiboheap::DenseFiboQueue<int, int> dq;
+    dq.push(1, 3);
+    dq.push(2, 5);
+    assert(!dq.erase(4 * n) && !dq.erase(4) && dq.erase(3) && !dq.erase(3));
+    assert(dq.size() == 1 && dq.topNode()->key == 5);
+    fq.removeNode(fq.find(1));
+    assert(!fq.contains(1) && fq.size() == size_t(n / 2 - 1));
+    fq.updatePriority(fq.find(3), "");
+    assert(fq.top().empty() && fq.topNode()->key == 3);
+    fq.updatePriority(fq.find(3), "~");
+    assert(fq.find(3)->priority == "~" && fq.topNode()->key != 3);
+    std::string last;
+    while(fq.size() > 1)
+    {
+        assert(last <= fq.top());
+        last = fq.top();
+        fq.pop();
+    }
+    assert(fq.topNode()->key == 3);
+}
+
+void checkKeyOnce(const int &n)
+{
+    using fiboheap::UpdateResult;
+    // keys long enough to live on the heap, so that a copied key would show in the store
+    auto name = [](int k) { return "a key that does not fit in the small string buffer #" + std::to_string(k); };
+    fiboheap::FiboQueue<int, std::string, int, std::less<int>, fiboheap::KeyOnceNodeStore> fq;
+    std::vector<int> priorities(n, -1);
+    for(int i = 0; i < 4 * n; i++)
+    {
+        int k = rand() % n;
+        int p = rand();
+        UpdateResult r = fq.upsert(name(k), p, k);
+        assert(r == (priorities[k] < 0 ? UpdateResult::Inserted : p < priorities[k] ? UpdateResult::Improved : UpdateResult::Unchanged));
+        priorities[k] = priorities[k] < 0 ? p : std::min(priorities[k], p);
+    }
+    for(int k = 0; k < n; k += 3)
+    {
+        if(priorities[k] >= 0)
+        {
+            assert(fq.tryDecrease(name(k), priorities[k] - 1) == UpdateResult::Improved);
+            --priorities[k];
+        }
+        else
+        {
+            assert(fq.tryDecrease(name(k), 0) == UpdateResult::Absent);
+            fq.emplace(priorities[k] = rand(), name(k), k);
+        }
+    }
+    for(int k = 1; k < n; k += 7)
+    {
+        assert(fq.erase(name(k)) == (priorities[k] >= 0));
+        priorities[k] = -1;
+    }
+    fiboheap::FiboQueue<int, std::string, int, std::less<int>, fiboheap::KeyOnceNodeStore> other;
+    other.push(-1, name(0), 0);
+    other.push(-2, name(n), n);
+    fq.meld(std::move(other));
+    priorities[0] = -1;
+    assert(fq.find(name(0))->priority == -1 && fq.top() == -2);
+    fq.pop();
+    std::set<std::pair<int, int>> order;
+    for(int k = 0; k < n; k++)
+    {
+        assert(fq.contains(name(k)) == (priorities[k] != -1 || k == 0));
+        if(fq.contains(name(k)))
+        {
+            assert(fq.find(name(k))->payload == k);
+            order.emplace(fq.find(name(k))->priority, k);
+        }
+    }
+    assert(fq.size() == order.size());
+    for(auto &e: order)
+    {
+        assert(fq.top() == e.first && fq.topNode()->key == name(e.second));
+        fq.pop();
+        assert(!fq.contains(name(e.second)));
+    }
+    assert(fq.empty());
+
+    fiboheap::IndexedDaryQueue<int, std::string, void, std::less<int>, 4, fiboheap::KeyOnceNodeStore> dq;
+    assert(dq.upsert(name(1), 3) == UpdateResult::Inserted);
+    assert(dq.upsert(name(2), 1) == UpdateResult::Inserted);
+    assert(dq.upsert(name(1), 0) == UpdateResult::Improved);
+    assert(dq.topNode()->key == name(1));
+}
+
+void checkStats(const int &n)
+{
+    using fiboheap::StatsOp;
+    static_assert(std::is_empty_v<fiboheap::NoStats>);
+    static_assert(sizeof(fiboheap::FiboHeap<int, int>) == sizeof(fiboheap::FiboHeap<int, int, void, std::less<int>, fiboheap::NoStats>));
+    fiboheap::FiboQueue<int, int, void, std::less<int>, fiboheap::HashNodeStore, fiboheap::FiboStats> fq;
+    // key 0 is the one popped, the odd keys are decreased
+    for(int i = 0; i < n; i++)
+    {
+        fq.push(i == 0 ? -1 : rand(), i);
+    }
+    fq.pop();
+    for(int i = 1; i < n; i += 2)
+    {
+        fq.tryDecrease(i, fq.find(i)->priority / 2);
+    }
+    fq.erase(n / 2);
+    fiboheap::FiboStatsSnapshot s = fq.stats().snapshot();
+    assert(s.nodes_allocated == static_cast<std::uint64_t>(n) && s.slabs_allocated > 0);
+    assert(s.links > 0 && s.max_degree > 0 && s.consolidations > 0);
+    assert(s.consolidated_roots >= s.max_root_list && s.max_root_list >= static_cast<std::uint64_t>(n) - 1);
+    assert(s.cuts >= s.cascading_cuts && s.cascading_cuts >= s.max_cascade_depth);
+    // push, pop, find, tryDecrease and erase by key each probe the store once
+    assert(s.store_probes == static_cast<std::uint64_t>(n + 1 + 2 * (n / 2) + 1));
+    auto total = [&s](StatsOp op) {
+        std::uint64_t sum = 0;
+        for(std::uint64_t c: s.histogram(op))
+        {
+            sum += c;
+        }
+        return sum;
+    };
+    // the heap operations nested in the queue ones are not timed twice
+    assert(total(StatsOp::Push) == static_cast<std::uint64_t>(n) && total(StatsOp::Pop) == 1);
+    assert(total(StatsOp::Decrease) == static_cast<std::uint64_t>(n / 2) && total(StatsOp::Erase) == 1);
+    fq.stats().resetStats();
+    assert(fq.stats().snapshot().links == 0);
+}
+
+void checkClear(const int &n)
+{
+    fiboheap::FiboQueue<int, int> fq;
+    for(int round = 0; round < 3; round++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            fq.push(rand(), i);
+        }
+        fq.pop();
+        for(int i = 0; i < n; i += 3)
+        {
+            fq.tryDecrease(i, -i);
+        }
+        size_t capacity = fq.capacity();
+        fq.clear();
+        assert(fq.empty() && fq.capacity() == capacity && !fq.contains(1));
+    }
+    for(int i = 0; i < n; i++)
+    {
+        fq.push(n - i, i);
+    }
+    for(int i = 1; i <= n; i++)
+    {
+        assert(fq.top() == i);
+        fq.pop();
+    }
+
+    // few elements left, their keys are erased one by one
+    fiboheap::DenseFiboQueue<int, int> dq;
+    for(int i = 0; i < n; i++)
+    {
+        dq.push(rand(), i);
+    }
+    while(dq.size() > 10)
+    {
+        dq.pop();
+    }
+    dq.clear();
+    for(int i = 0; i < n; i++)
+    {
+        assert(!dq.contains(i));
+    }
+    assert(dq.upsert(0, 1) == fiboheap::UpdateResult::Inserted && dq.size() == 1);
+
+    // incremental mode, with a payload that must be destroyed
+    fiboheap::FiboQueue<int, int, std::string> sq;
+    sq.setConsolidationBudget(2);
+    for(int round = 0; round < 2; round++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            sq.push(rand(), i, std::string(32, 'a' + i % 26));
+        }
+        sq.pop();
+        sq.clear();
+        assert(sq.empty() && sq.consolidationBudget() == 2);
+    }
+    sq.push(2, 2, "b");
+    sq.push(1, 1, "a");
+    assert(sq.topNode()->payload == "a");
+
+    // a single path of n * 100 nodes, built by linking a new root over the path and cutting its other child
+    fiboheap::FiboHeap<int, int, std::string> h;
+    int next = 0;
+    auto *leaf = h.push(next--, 0, "leaf");
+    for(int i = 0; i < 100 * n; i++)
+    {
+        h.push(next - 2, 0);
+        auto *y = h.push(next - 1, 0, "cut");
+        h.push(next - 3, 0);
+        next -= 4;
+        h.pop();
+        h.decreasePriority(y, next--);
+        h.pop();
+    }
+    int depth = 0;
+    for(auto *x = leaf; x != nullptr; x = x->p)
+    {
+        ++depth;
+    }
+    assert(depth == 100 * n + 1 && h.size() == size_t(depth));
+    h.clear();
+    assert(h.empty());
+    h.push(1, 1, "again");
+    assert(h.top() == 1);
+}
+
+//! Payload whose copy throws once a budget of copies is spent
+struct CopyBudget
+{
+    static int copies;
+
+    explicit CopyBudget(int v)
+        : value(std::to_string(v))
+    {}
+
+    CopyBudget(const CopyBudget &other)
+        : value(other.value)
+    {
+        if(--copies < 0)
+        {
+            throw std::runtime_error("copy budget spent");
+        }
+    }
+
+    CopyBudget &operator=(const CopyBudget &) = default;
+
+    std::string value;
+};
+
+int CopyBudget::copies = 0;
+
+void checkClone(const int &n)
+{
+    using Queue = fiboheap::FiboQueue<int, int, std::string>;
+    for(size_t budget: {0, 3})
+    {
+        Queue fq;
+        fq.setConsolidationBudget(budget);
+        for(int i = 0; i < n; i++)
+        {
+            fq.push(rand() % n, i, std::to_string(i));
+        }
+        fq.pop();
+        for(int i = 0; i < n; i += 5)
+        {
+            fq.tryDecrease(i, -i);
+        }
+        fq.pop();
+        Queue copy = fq.clone();
+        assert(copy.size() == fq.size() && copy.consolidationBudget() == budget);
+        for(int i = 0; i < n; i++)
+        {
+            auto *x = fq.find(i);
+            auto *y = copy.find(i);
+            assert((x == nullptr) == (y == nullptr));
+            if(x != nullptr)
+            {
+                assert(x != y && y->priority == x->priority && y->payload == x->payload);
+                assert(y->degree == x->degree && y->mark == x->mark);
+                assert((y->p == nullptr) == (x->p == nullptr) && (y->p == nullptr || y->p->key == x->p->key));
+            }
+        }
+        // the copy is independent of the original
+        int k = 0;
+        while(!fq.contains(k) || k == fq.topNode()->key)
+        {
+            k++;
+        }
+        copy.tryDecrease(k, -n);
+        assert(copy.top() == -n && fq.top() != -n);
+        copy.pop();
+        fq.erase(k);
+        Queue assigned;
+        assigned.push(0, n + 1, "gone");
+        assigned = fq;
+        assert(!assigned.contains(n + 1));
+        while(!fq.empty())
+        {
+            assert(copy.top() == fq.top() && assigned.top() == fq.top());
+            assert(copy.topNode()->payload == std::to_string(copy.topNode()->key));
+            fq.pop();
+            copy.pop();
+            assigned.pop();
+        }
+        assert(copy.empty() && assigned.empty());
+    }
+
+    fiboheap::FiboHeap<int, int> h;
+    for(int i = 0; i < n; i++)
+    {
+        h.push(rand(), i);
+    }
+    h.pop();
+    fiboheap::FiboHeap<int, int> hc(h);
+    h.push(-1, -1);
+    assert(hc.size() == size_t(n - 1) && hc.top() != -1);
+    h.pop();
+    while(!hc.empty())
+    {
+        assert(h.top() == hc.top());
+        h.pop();
+        hc.pop();
+    }
+    assert(h.empty());
+
+    fiboheap::CompactFiboHeap<int, int> ch;
+    for(int i = 0; i < n; i++)
+    {
+        ch.push(rand(), i);
+    }
+    ch.pop();
+    auto cc = ch.clone();
+    while(!ch.empty())
+    {
+        assert(cc.top() == ch.top() && cc.key(cc.topIndex()) == ch.key(ch.topIndex()));
+        ch.pop();
+        cc.pop();
+    }
+
+    // after a meld the nodes are spread over the slabs of both pools, and a clear() carves them again
+    auto same = [](auto a, auto b) {
+        assert(a.size() == b.size());
+        while(!a.empty())
+        {
+            assert(a.top() == b.top() && a.topNode()->key == b.topNode()->key);
+            a.pop();
+            b.pop();
+        }
+    };
+    fiboheap::FiboQueue<int, std::string, void, std::less<int>, fiboheap::KeyOnceNodeStore> mq, other;
+    for(int i = 0; i < n; i++)
+    {
+        (i % 3 ? mq : other).push(i, std::to_string(i));
+    }
+    other.pop();
+    mq.pop();
+    mq.meld(std::move(other));
+    for(int i = 0; i < n / 2; i++)
+    {
+        mq.pop();
+    }
+    same(mq, mq.clone());
+    mq.clear();
+    std::set<const void *> addresses;
+    for(int i = 0; i < 2 * n; i++)
+    {
+        assert(addresses.insert(mq.push(rand(), std::to_string(i))).second);
+    }
+    same(mq, mq.clone());
+
+    // a copy that throws leaves an empty queue behind
+    fiboheap::FiboQueue<int, int, CopyBudget> bq;
+    for(int i = 0; i < n; i++)
+    {
+        bq.emplace(rand(), i, i);
+    }
+    bq.pop();
+    fiboheap::FiboQueue<int, int, CopyBudget> target;
+    target.emplace(0, 0, 0);
+    CopyBudget::copies = n / 2;
+    bool thrown = false;
+    try
+    {
+        target = bq;
+    }
+    catch(const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown && target.empty() && !target.contains(0));
+    CopyBudget::copies = n;
+    target = bq;
+    assert(target.size() == bq.size() && target.top() == bq.top());
+
+    // a move copies no node: the moved-to queue keeps the nodes at their addresses, the moved-from one is empty
+    CopyBudget::copies = 0;
+    std::vector<const void *> nodes;
+    for(int i = 0; i < n; i++)
+    {
+        nodes.push_back(bq.find(i));
+    }
+    auto moved = std::move(bq);
+    assert(bq.empty() && bq.size() == 0 && !bq.contains(1) && moved.size() == target.size());
+    target = std::move(moved);
+    assert(moved.empty() && !moved.contains(1));
+    for(int i = 0; i < n; i++)
+    {
+        assert(target.find(i) == nodes[i]);
+    }
+    bq.emplace(0, 0, 0);
+    moved.emplace(1, 1, 1);
+    assert(bq.size() == 1 && moved.size() == 1 && moved.top() == 1);
+    fiboheap::FiboHeap<int, int> mh;
+    const void *top = mh.push(-1, -1);
+    for(int i = 0; i < n; i++)
+    {
+        mh.push(rand(), i);
+    }
+    fiboheap::FiboHeap<int, int> mt(std::move(mh));
+    assert(mh.empty() && mh.topNode() == nullptr && mt.size() == (size_t)n + 1 && mt.topNode() == top);
+}
+
+void checkSaveLoad(const int &n)
+{
+    using Queue = fiboheap::FiboQueue<int, int, long>;
+    const std::string path = (std::filesystem::temp_directory_path() / "fiboheap_check_save_load.bin").string();
+    for(size_t budget: {0, 3})
+    {
+        Queue fq;
+        fq.setConsolidationBudget(budget);
+        for(int i = 0; i < n; i++)
+        {
+            fq.push(rand() % n, i, 3L * i);
+        }
+        fq.pop();
+        for(int i = 0; i < n; i += 5)
+        {
+            fq.tryDecrease(i, -i);
+        }
+        fq.pop();
+        fq.save(path);
+
+        // the second load cannot be mapped where the first one is, and has its links rebased
+        Queue a, b;
+        a.push(0, n + 1, 0);
+        a.load(path);
+        b.setConsolidationBudget(2);
+        b.load(path);
+        assert(!a.contains(n + 1) && a.size() == fq.size() && b.size() == fq.size());
+        assert(a.consolidationBudget() == 0 && b.consolidationBudget() == 2);
+        for(int i = 0; i < n; i++)
+        {
+            auto *x = fq.find(i);
+            auto *y = a.find(i);
+            assert((x == nullptr) == (y == nullptr) && (x == nullptr) == (b.find(i) == nullptr));
+            if(x != nullptr)
+            {
+                assert(y->priority == x->priority && y->payload == x->payload);
+                assert(y->degree == x->degree && y->mark == x->mark);
+                assert((y->p == nullptr) == (x->p == nullptr) && (y->p == nullptr || y->p->key == x->p->key));
+            }
+        }
+
+        // a tabled heap saves its degree table and pending roots
+        b.save(path);
+        Queue c;
+        c.load(path);
+        assert(c.size() == fq.size());
+
+        // loaded nodes behave like any other
+        a.push(-2 * n, n + 2, 7);
+        assert(a.top() == -2 * n);
+        a.pop();
+        int k = 0;
+        while(!fq.contains(k) || k == fq.topNode()->key)
+        {
+            k++;
+        }
+        for(Queue *q: {&fq, &a, &b, &c})
+        {
+            q->tryDecrease(k, -n - 1);
+            assert(q->top() == -n - 1);
+        }
+        while(!fq.empty())
+        {
+            for(Queue *q: {&a, &b, &c})
+            {
+                assert(q->top() == fq.top() && q->topNode()->payload == 3L * q->topNode()->key);
+                q->pop();
+            }
+            fq.pop();
+        }
+        assert(a.empty() && b.empty() && c.empty());
+
+        // the mapped storage is carved again after clear()
+        a.load(path);
+        a.clear();
+        std::set<const void *> addresses;
+        for(int i = 0; i < 2 * n; i++)
+        {
+            assert(addresses.insert(a.push(rand(), i, i)).second);
+        }
+        int last = a.top();
+        while(!a.empty())
+        {
+            assert(a.top() >= last);
+            last = a.top();
+            a.pop();
+        }
+    }
+
+    // a loaded heap melded into another one keeps its file mapped
+    fiboheap::FiboHeap<int, int> h, g;
+    for(int i = 0; i < n; i++)
+    {
+        h.push(rand(), i % 10);
+        g.push(rand(), i);
+    }
+    h.pop();
+    h.save(path);
+    fiboheap::FiboHeap<int, int> r(g);
+    r.meld(h.clone());
+    {
+        fiboheap::FiboHeap<int, int> l;
+        l.load(path);
+        g.meld(std::move(l));
+    }
+    assert(g.size() == r.size());
+    while(!g.empty())
+    {
+        assert(g.top() == r.top());
+        g.pop();
+        r.pop();
+    }
+    h.clear();
+
+    // an empty heap round trips, an invalid file leaves the queue empty
+    h.save(path);
+    fiboheap::FiboHeap<int, int> e;
+    e.push(1, 1);
+    e.load(path);
+    assert(e.empty());
+    e.push(2, 2);
+    assert(e.top() == 2);
+    auto throws = [&path](auto &q) {
+        bool thrown = false;
+        try
+        {
+            q.load(path);
+        }
+        catch(const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        return thrown && q.empty();
+    };
+    for(int i = 0; i < 3; i++)
+    {
+        h.push(i, 7);
+    }
+    h.save(path);
+    fiboheap::FiboQueue<int, int> dq;
+    dq.push(0, 0);
+    assert(throws(dq) && !dq.contains(0) && !dq.contains(7));
+    Queue wq;
+    assert(throws(wq));
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(8192, 'x');
+    assert(throws(wq));
+    std::filesystem::remove(path);
+    assert(throws(wq));
+}
+
+struct ExternalId
+{
+    explicit ExternalId(int v)
+        : v(v)
+    {}
+    bool operator==(const ExternalId &o) const
+    {
+        return v == o.v;
+    }
+    int v;
+};
+
+std::ostream &operator<<(std::ostream &os, const ExternalId &id)
+{
+    return os << id.v;
+}
+
+namespace std
+{
+    template <>
+    struct hash<ExternalId>
+    {
+        size_t operator()(const ExternalId &id) const
+        {
+            return std::hash<int>()(id.v);
+        }
+    };
+}  // namespace std
+
+void checkExternal(const int &n)
+{
+    // a budget of 32 hot elements and blocks of 16 entries, so that runs are spilled, merged and compacted often
+    using External = fiboheap::ExternalQueue<int, int>;
+    const std::string directory = std::filesystem::temp_directory_path().string();
+    External eq(128 * External::kEntryBytes, directory, 16 * 16);
+    fiboheap::FiboQueue<int, int> ref;
+    size_t max_runs = 0;
+    for(int round = 0; round < 8; round++)
+    {
+        for(int i = 0; i < 2 * n; i++)
+        {
+            // keys popped before come back, as with the other queues
+            int k = rand() % n;
+            int p = rand() % (10 * n);
+            eq.upsert(k, p);
+            ref.upsert(k, p);
+            max_runs = std::max(max_runs, eq.runs());
+        }
+        assert(eq.runs() > 0 && eq.size() >= ref.size());
+        for(int i = 0; i < n / 2 && !ref.empty(); i++)
+        {
+            assert(!eq.empty() && eq.top() == ref.top());
+            int k = eq.topKey();
+            // ties may pop another key with the same priority
+            assert(ref.find(k) != nullptr && ref.find(k)->priority == eq.top());
+            ref.erase(k);
+            eq.pop();
+        }
+    }
+    // merging by levels keeps the run count logarithmic
+    assert(max_runs < 64 && eq.spilled() > (size_t)n);
+    while(!ref.empty())
+    {
+        int k = eq.topKey();
+        assert(eq.top() == ref.find(k)->priority);
+        ref.erase(k);
+        eq.pop();
+    }
+    assert(eq.empty() && eq.runs() == 0 && eq.size() == 0 && eq.records() == 0);
+
+    // clear() removes the runs
+    for(int i = 0; i < n; i++)
+    {
+        eq.upsert(n + i, rand());
+    }
+    assert(eq.runs() > 0);
+    eq.clear();
+    assert(eq.empty() && eq.records() == 0);
+    size_t files = 0;
+    for(const auto &entry: std::filesystem::directory_iterator(directory))
+    {
+        files += entry.path().extension() == ".run" && entry.path().filename().string().rfind("fiboheap_", 0) == 0;
+    }
+    assert(files == 0);
+
+    // keys need not be default constructible
+    fiboheap::ExternalQueue<int, ExternalId> iq(16 * External::kEntryBytes, directory, 256);
+    for(int i = 0; i < n; i++)
+    {
+        iq.upsert(ExternalId(i), n - i);
+    }
+    for(int i = n - 1; i >= 0; i--)
+    {
+        assert(iq.topKey() == ExternalId(i));
+        iq.pop();
+    }
+    assert(iq.empty());
+}
+
 int main(int argc, char *argv[])
 {
     fiboheap::FiboHeap<int, int> fh;
@@ -96,7 +1786,7 @@ int main(int argc, char *argv[])
     fillHeaps(fh, pqueue, n);
     int r = pqueue.top() - 1;
     pqueue.pop();
-    pqueue.push(r, r);
+    pqueue.push(r);
     std::make_heap(const_cast<int *>(&pqueue.top()), const_cast<int *>(&pqueue.top()) + pqueue.size(), lowerI());
     fh.decreasePriority(fh.topNode(), r);
     matchHeaps(fh, pqueue);
@@ -107,11 +1797,35 @@ int main(int argc, char *argv[])
 
     fillQueues(fq, pqueue, n);
     r = rand();
-    fq.push(r);
+    fq.push(r, r);
     auto *x = fq.findNode(r);
     assert(x != nullptr);
     int nr = r - rand() / 2;
     fq.decreasePriority(x, nr);
     pqueue.push(nr);
     matchQueues(fq, pqueue);
+
+    checkReserve(1000);
+    checkPayload();
+    checkCompact(1000);
+    checkRange(1000);
+    checkPopN(1000);
+    checkDecreaseBatch(1000);
+    checkUpsert();
+    checkDense(1000);
+    checkPairing(1000);
+    checkRadix(1000);
+    checkDary(1000);
+    checkBucket(1000);
+    checkMultiQueue(1000);
+    checkIngest(1000);
+    checkIncremental(1000);
+    checkMeld(1000);
+    checkUpdateErase(1000);
+    checkKeyOnce(1000);
+    checkStats(1000);
+    checkClear(1000);
+    checkClone(1000);
+    checkSaveLoad(1000);
+    checkExternal(1000);
 }